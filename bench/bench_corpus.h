@@ -0,0 +1,301 @@
+/* Copyright (c) 2026 VillageSQL Contributors
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <https://www.gnu.org/licenses/>.
+ */
+
+// Deterministic input corpora for the microbenchmarks. Each corpus is a
+// fixed-seed sample shaped like real traffic: mostly private IPv4 with a
+// tail of public space, IPv6 drawn from a few /32s with the zero runs real
+// addresses have, MAC addresses in the three common notations, and a mix of
+// near-miss invalid inputs.
+
+#ifndef NETWORK_ADDRESS_BENCH_CORPUS_H
+#define NETWORK_ADDRESS_BENCH_CORPUS_H
+
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "network_address_core.h"
+
+namespace network_address_bench {
+
+// Power of two so benchmarks can cycle with a mask
+static constexpr size_t kCorpusSize = 4096;
+
+enum class Corpus {
+  kIPv4,             // dotted quads, some with a prefix length
+  kIPv6Compressed,   // RFC 5952 text with "::"
+  kIPv6Expanded,     // eight four-digit groups
+  kMixed,            // 70% IPv4, 30% IPv6 (compressed)
+  kIPv4Networks,     // CIDR text with host bits clear
+  kIPv6Networks,
+  kMixedNetworks,
+  kMacColon,         // 08:00:2b:01:02:03
+  kMacHyphen,        // 08-00-2B-01-02-03
+  kMacDotted,        // 0800.2b01.0203
+  kMac8Colon,        // 08:00:2b:01:02:03:04:05
+  kInvalid,          // malformed addresses of every kind
+  kAccessLog,        // bare client addresses, 85% IPv4, as in web logs
+  kHotClients,       // access-log addresses, 80% drawn from 1000 hot clients
+};
+
+inline std::string format_ipv4_text(uint32_t address, int masklen) {
+  char buf[32];
+  if (masklen >= 0) {
+    snprintf(buf, sizeof(buf), "%u.%u.%u.%u/%d", address >> 24,
+             (address >> 16) & 0xFF, (address >> 8) & 0xFF, address & 0xFF,
+             masklen);
+  } else {
+    snprintf(buf, sizeof(buf), "%u.%u.%u.%u", address >> 24,
+             (address >> 16) & 0xFF, (address >> 8) & 0xFF, address & 0xFF);
+  }
+  return buf;
+}
+
+// Format eight groups either fully expanded or with the longest run of two
+// or more zero groups compressed to "::"
+inline std::string format_ipv6_text(const uint16_t *groups, bool compress,
+                                    int masklen) {
+  int best_start = -1, best_len = 0;
+  if (compress) {
+    for (int i = 0; i < 8;) {
+      if (groups[i] != 0) {
+        i++;
+        continue;
+      }
+      int j = i;
+      while (j < 8 && groups[j] == 0) j++;
+      if (j - i > best_len && j - i >= 2) {
+        best_start = i;
+        best_len = j - i;
+      }
+      i = j;
+    }
+  }
+
+  std::string text;
+  char part[8];
+  for (int i = 0; i < 8; i++) {
+    if (i == best_start) {
+      text += "::";
+      i += best_len - 1;
+      continue;
+    }
+    if (!text.empty() && text.back() != ':') text += ':';
+    snprintf(part, sizeof(part), compress ? "%x" : "%04x", groups[i]);
+    text += part;
+  }
+  if (masklen >= 0) {
+    text += '/';
+    text += std::to_string(masklen);
+  }
+  return text;
+}
+
+class CorpusBuilder {
+ public:
+  explicit CorpusBuilder(uint64_t seed) : rng_(seed) {}
+
+  std::vector<std::string> build(Corpus kind) {
+    std::vector<std::string> out;
+    out.reserve(kCorpusSize);
+    for (size_t i = 0; i < kCorpusSize; i++) {
+      out.push_back(one(kind));
+    }
+    return out;
+  }
+
+ private:
+  uint32_t next(uint32_t bound) {
+    return std::uniform_int_distribution<uint32_t>(0, bound - 1)(rng_);
+  }
+
+  uint32_t ipv4_address() {
+    uint32_t r = next(100);
+    uint32_t host = static_cast<uint32_t>(rng_());
+    if (r < 40) return 0x0A000000u | (host & 0x00FFFFFFu);  // 10/8
+    if (r < 65) return 0xC0A80000u | (host & 0x0000FFFFu);  // 192.168/16
+    if (r < 75) return 0xAC100000u | (host & 0x000FFFFFu);  // 172.16/12
+    return host;                                             // public
+  }
+
+  int ipv4_masklen() {
+    static const int kMasks[] = {-1, -1, -1, 32, 24, 24, 16, 8, 20, 28};
+    return kMasks[next(10)];
+  }
+
+  void ipv6_groups(uint16_t *groups) {
+    static const uint16_t kPrefixes[][2] = {
+        {0x2001, 0x0db8}, {0x2a00, 0x1450}, {0x2600, 0x1f18}, {0xfe80, 0}};
+    const uint16_t *prefix = kPrefixes[next(4)];
+    groups[0] = prefix[0];
+    groups[1] = prefix[1];
+    groups[2] = prefix[0] == 0xfe80 ? 0 : static_cast<uint16_t>(next(0x10000));
+    groups[3] = next(3) == 0 ? 0 : static_cast<uint16_t>(next(0x100));
+    uint32_t shape = next(3);
+    for (int i = 4; i < 8; i++) {
+      // Host parts: ::1-style, SLAAC-style random, or a sparse middle
+      if (shape == 0) groups[i] = i == 7 ? static_cast<uint16_t>(1 + next(0xff)) : 0;
+      else if (shape == 1) groups[i] = static_cast<uint16_t>(next(0x10000));
+      else groups[i] = (i == 5) ? 0 : static_cast<uint16_t>(next(0x10000));
+    }
+  }
+
+  int ipv6_masklen() {
+    static const int kMasks[] = {-1, -1, -1, 128, 64, 64, 48, 56};
+    return kMasks[next(8)];
+  }
+
+  std::string ipv4_network() {
+    int masklen = 8 + next(25);
+    uint32_t mask = network_address::prefix_to_netmask_ipv4(masklen);
+    return format_ipv4_text(ipv4_address() & mask, masklen);
+  }
+
+  std::string ipv6_network() {
+    uint16_t groups[8];
+    ipv6_groups(groups);
+    int masklen = 16 * (1 + next(4));  // /16 /32 /48 /64
+    for (int i = masklen / 16; i < 8; i++) groups[i] = 0;
+    return format_ipv6_text(groups, true, masklen);
+  }
+
+  std::string mac(int bytes, char sep, bool upper) {
+    static const uint8_t kOuis[][3] = {
+        {0x08, 0x00, 0x2b}, {0x00, 0x1b, 0x21}, {0x3c, 0x22, 0xfb},
+        {0xf4, 0x5c, 0x89}};
+    uint8_t octets[8];
+    const uint8_t *oui = kOuis[next(4)];
+    for (int i = 0; i < bytes; i++) {
+      octets[i] = i < 3 ? oui[i] : static_cast<uint8_t>(next(256));
+    }
+
+    std::string text;
+    char part[4];
+    const char *fmt = upper ? "%02X" : "%02x";
+    for (int i = 0; i < bytes; i++) {
+      if (sep == '.') {
+        if (i > 0 && i % 2 == 0) text += '.';
+      } else if (i > 0) {
+        text += sep;
+      }
+      snprintf(part, sizeof(part), fmt, octets[i]);
+      text += part;
+    }
+    return text;
+  }
+
+  std::string client_address() {
+    if (next(100) < 85) return format_ipv4_text(ipv4_address(), -1);
+    uint16_t groups[8];
+    ipv6_groups(groups);
+    return format_ipv6_text(groups, true, -1);
+  }
+
+  std::string invalid() {
+    switch (next(10)) {
+      case 0: return "256." + std::to_string(next(256)) + ".1.1";
+      case 1: return std::to_string(next(256)) + "." + std::to_string(next(256)) + ".1";
+      case 2: return "2001:db8:::" + std::to_string(next(10));
+      case 3: return "2001:db8::" + std::to_string(next(10)) + "::1";
+      case 4: return format_ipv4_text(ipv4_address(), 33 + next(10));
+      case 5: return "fe80::1/" + std::to_string(129 + next(100));
+      case 6: return "08:00:2b:01:02";
+      case 7: return "08:00:2b:01:02:03:04:05:06";
+      case 8: return "host-" + std::to_string(next(100000)) + ".example.com";
+      default: return "";
+    }
+  }
+
+  std::string one(Corpus kind) {
+    uint16_t groups[8];
+    switch (kind) {
+      case Corpus::kIPv4:
+        return format_ipv4_text(ipv4_address(), ipv4_masklen());
+      case Corpus::kIPv6Compressed:
+        ipv6_groups(groups);
+        return format_ipv6_text(groups, true, ipv6_masklen());
+      case Corpus::kIPv6Expanded:
+        ipv6_groups(groups);
+        return format_ipv6_text(groups, false, ipv6_masklen());
+      case Corpus::kMixed:
+        if (next(10) < 7) return format_ipv4_text(ipv4_address(), ipv4_masklen());
+        ipv6_groups(groups);
+        return format_ipv6_text(groups, true, ipv6_masklen());
+      case Corpus::kIPv4Networks:
+        return ipv4_network();
+      case Corpus::kIPv6Networks:
+        return ipv6_network();
+      case Corpus::kMixedNetworks:
+        return next(10) < 7 ? ipv4_network() : ipv6_network();
+      case Corpus::kAccessLog:
+        return client_address();
+      case Corpus::kHotClients:
+        if (hot_.empty()) {
+          for (int i = 0; i < 1000; i++) hot_.push_back(client_address());
+        }
+        if (next(100) < 80) return hot_[next(static_cast<uint32_t>(hot_.size()))];
+        return client_address();
+      case Corpus::kMacColon:
+        return mac(6, ':', false);
+      case Corpus::kMacHyphen:
+        return mac(6, '-', true);
+      case Corpus::kMacDotted:
+        return mac(6, '.', false);
+      case Corpus::kMac8Colon:
+        return mac(8, ':', false);
+      case Corpus::kInvalid:
+        return invalid();
+    }
+    return std::string();
+  }
+
+  std::mt19937_64 rng_;
+  std::vector<std::string> hot_;
+};
+
+// Build a text corpus with the fixed benchmark seed
+inline std::vector<std::string> make_corpus(Corpus kind) {
+  return CorpusBuilder(0x5eed0001u + static_cast<uint64_t>(kind)).build(kind);
+}
+
+// An encoded value in its on-disk form
+struct Encoded {
+  unsigned char bytes[sizeof(network_address::IPv6Network)];
+  size_t length;
+};
+
+using EncodeFn = bool (*)(unsigned char *, size_t, const char *, size_t,
+                          size_t *);
+
+// Encode every valid entry of a text corpus (invalid entries are skipped)
+inline std::vector<Encoded> encode_corpus(const std::vector<std::string> &text,
+                                          EncodeFn encode) {
+  std::vector<Encoded> out;
+  out.reserve(text.size());
+  for (const std::string &s : text) {
+    Encoded e;
+    if (!encode(e.bytes, sizeof(e.bytes), s.data(), s.size(), &e.length)) {
+      out.push_back(e);
+    }
+  }
+  return out;
+}
+
+} // namespace network_address_bench
+
+#endif // NETWORK_ADDRESS_BENCH_CORPUS_H
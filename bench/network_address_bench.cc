@@ -0,0 +1,545 @@
+/* Copyright (c) 2026 VillageSQL Contributors
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <https://www.gnu.org/licenses/>.
+ */
+
+// Microbenchmarks for the core kernels. Every benchmark cycles through a
+// fixed corpus (see bench_corpus.h) and reports items/second, so results
+// from two builds can be compared entry by entry.
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "bench_corpus.h"
+#include "network_address_core.h"
+
+using network_address_bench::Corpus;
+using network_address_bench::EncodeFn;
+using network_address_bench::Encoded;
+using network_address_bench::encode_corpus;
+using network_address_bench::make_corpus;
+
+namespace {
+
+using DecodeFn = bool (*)(const unsigned char *, size_t, char *, size_t,
+                          size_t *);
+using CompareFn = int (*)(const unsigned char *, size_t, const unsigned char *,
+                          size_t);
+
+// ============================================================================
+// Encoding / decoding
+// ============================================================================
+
+void BM_Encode(benchmark::State &state, EncodeFn encode, Corpus kind) {
+  const std::vector<std::string> corpus = make_corpus(kind);
+  unsigned char buffer[sizeof(network_address::IPv6Network)];
+  size_t length;
+  size_t i = 0;
+  for (auto _ : state) {
+    const std::string &s = corpus[i];
+    bool error = encode(buffer, sizeof(buffer), s.data(), s.size(), &length);
+    benchmark::DoNotOptimize(error);
+    benchmark::DoNotOptimize(buffer);
+    if (++i == corpus.size()) i = 0;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+void BM_Decode(benchmark::State &state, EncodeFn encode, DecodeFn decode,
+               Corpus kind) {
+  const std::vector<Encoded> values = encode_corpus(make_corpus(kind), encode);
+  char text[64];
+  size_t length;
+  size_t i = 0;
+  for (auto _ : state) {
+    const Encoded &v = values[i];
+    bool error = decode(v.bytes, v.length, text, sizeof(text), &length);
+    benchmark::DoNotOptimize(error);
+    benchmark::DoNotOptimize(text);
+    if (++i == values.size()) i = 0;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK_CAPTURE(BM_Encode, inet/ipv4, &network_address::encode_inet, Corpus::kIPv4);
+BENCHMARK_CAPTURE(BM_Encode, inet/ipv6_compressed, &network_address::encode_inet, Corpus::kIPv6Compressed);
+BENCHMARK_CAPTURE(BM_Encode, inet/ipv6_expanded, &network_address::encode_inet, Corpus::kIPv6Expanded);
+BENCHMARK_CAPTURE(BM_Encode, inet/mixed, &network_address::encode_inet, Corpus::kMixed);
+BENCHMARK_CAPTURE(BM_Encode, inet/invalid, &network_address::encode_inet, Corpus::kInvalid);
+BENCHMARK_CAPTURE(BM_Encode, inet/access_log, &network_address::encode_inet, Corpus::kAccessLog);
+BENCHMARK_CAPTURE(BM_Encode, cidr/ipv4, &network_address::encode_cidr, Corpus::kIPv4Networks);
+BENCHMARK_CAPTURE(BM_Encode, cidr/ipv6, &network_address::encode_cidr, Corpus::kIPv6Networks);
+BENCHMARK_CAPTURE(BM_Encode, cidr/mixed, &network_address::encode_cidr, Corpus::kMixedNetworks);
+BENCHMARK_CAPTURE(BM_Encode, cidr/invalid, &network_address::encode_cidr, Corpus::kInvalid);
+BENCHMARK_CAPTURE(BM_Encode, macaddr/colon, &network_address::encode_macaddr, Corpus::kMacColon);
+BENCHMARK_CAPTURE(BM_Encode, macaddr/hyphen, &network_address::encode_macaddr, Corpus::kMacHyphen);
+BENCHMARK_CAPTURE(BM_Encode, macaddr/dotted, &network_address::encode_macaddr, Corpus::kMacDotted);
+BENCHMARK_CAPTURE(BM_Encode, macaddr/invalid, &network_address::encode_macaddr, Corpus::kInvalid);
+BENCHMARK_CAPTURE(BM_Encode, macaddr8/colon, &network_address::encode_macaddr8, Corpus::kMac8Colon);
+BENCHMARK_CAPTURE(BM_Encode, inet4, &network_address::encode_inet4, Corpus::kIPv4);
+BENCHMARK_CAPTURE(BM_Encode, inet6, &network_address::encode_inet6, Corpus::kIPv6Compressed);
+
+// Parse cache off (0) and on (1); the corpus repeats every kCorpusSize rows
+void BM_EncodeParseCache(benchmark::State &state, EncodeFn encode,
+                         Corpus kind) {
+  const bool was_enabled =
+      network_address::set_parse_cache_enabled(state.range(0) != 0);
+  BM_Encode(state, encode, kind);
+  network_address::set_parse_cache_enabled(was_enabled);
+}
+
+BENCHMARK_CAPTURE(BM_EncodeParseCache, inet/access_log, &network_address::encode_inet, Corpus::kAccessLog)->Arg(0)->Arg(1);
+BENCHMARK_CAPTURE(BM_EncodeParseCache, inet/hot_clients, &network_address::encode_inet, Corpus::kHotClients)->Arg(0)->Arg(1);
+BENCHMARK_CAPTURE(BM_EncodeParseCache, inet/ipv6_compressed, &network_address::encode_inet, Corpus::kIPv6Compressed)->Arg(0)->Arg(1);
+BENCHMARK_CAPTURE(BM_EncodeParseCache, cidr/mixed, &network_address::encode_cidr, Corpus::kMixedNetworks)->Arg(0)->Arg(1);
+BENCHMARK_CAPTURE(BM_EncodeParseCache, macaddr/colon, &network_address::encode_macaddr, Corpus::kMacColon)->Arg(0)->Arg(1);
+
+BENCHMARK_CAPTURE(BM_Decode, inet/ipv4, &network_address::encode_inet, &network_address::decode_inet, Corpus::kIPv4);
+BENCHMARK_CAPTURE(BM_Decode, inet/ipv6, &network_address::encode_inet, &network_address::decode_inet, Corpus::kIPv6Compressed);
+BENCHMARK_CAPTURE(BM_Decode, inet/mixed, &network_address::encode_inet, &network_address::decode_inet, Corpus::kMixed);
+BENCHMARK_CAPTURE(BM_Decode, cidr/ipv4, &network_address::encode_cidr, &network_address::decode_cidr, Corpus::kIPv4Networks);
+BENCHMARK_CAPTURE(BM_Decode, cidr/ipv6, &network_address::encode_cidr, &network_address::decode_cidr, Corpus::kIPv6Networks);
+BENCHMARK_CAPTURE(BM_Decode, macaddr, &network_address::encode_macaddr, &network_address::decode_macaddr, Corpus::kMacColon);
+BENCHMARK_CAPTURE(BM_Decode, macaddr8, &network_address::encode_macaddr8, &network_address::decode_macaddr8, Corpus::kMac8Colon);
+BENCHMARK_CAPTURE(BM_Decode, inet4, &network_address::encode_inet4, &network_address::decode_inet4, Corpus::kIPv4);
+BENCHMARK_CAPTURE(BM_Decode, inet6, &network_address::encode_inet6, &network_address::decode_inet6, Corpus::kIPv6Compressed);
+
+// Format cache off/on over the first range(1) values of the corpus, as when
+// printing the keys of a GROUP BY
+void BM_DecodeFormatCache(benchmark::State &state, EncodeFn encode,
+                          DecodeFn decode, Corpus kind) {
+  std::vector<Encoded> values = encode_corpus(make_corpus(kind), encode);
+  values.resize(std::min(values.size(), static_cast<size_t>(state.range(1))));
+  const bool was_enabled =
+      network_address::set_format_cache_enabled(state.range(0) != 0);
+  char text[64];
+  size_t length;
+  size_t i = 0;
+  for (auto _ : state) {
+    const Encoded &v = values[i];
+    bool error = decode(v.bytes, v.length, text, sizeof(text), &length);
+    benchmark::DoNotOptimize(error);
+    benchmark::DoNotOptimize(text);
+    if (++i == values.size()) i = 0;
+  }
+  network_address::set_format_cache_enabled(was_enabled);
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK_CAPTURE(BM_DecodeFormatCache, inet/ipv4, &network_address::encode_inet, &network_address::decode_inet, Corpus::kIPv4)->ArgsProduct({{0, 1}, {256, 4096}});
+BENCHMARK_CAPTURE(BM_DecodeFormatCache, inet/ipv6, &network_address::encode_inet, &network_address::decode_inet, Corpus::kIPv6Compressed)->ArgsProduct({{0, 1}, {256, 4096}});
+BENCHMARK_CAPTURE(BM_DecodeFormatCache, cidr/mixed, &network_address::encode_cidr, &network_address::decode_cidr, Corpus::kMixedNetworks)->ArgsProduct({{0, 1}, {256, 4096}});
+BENCHMARK_CAPTURE(BM_DecodeFormatCache, macaddr, &network_address::encode_macaddr, &network_address::decode_macaddr, Corpus::kMacColon)->ArgsProduct({{0, 1}, {256, 4096}});
+
+// ============================================================================
+// Comparison
+// ============================================================================
+
+// Compare each value with its neighbour in an unsorted corpus, the access
+// pattern of a sort or index build
+void BM_Compare(benchmark::State &state, EncodeFn encode, CompareFn compare,
+                Corpus kind) {
+  const std::vector<Encoded> values = encode_corpus(make_corpus(kind), encode);
+  size_t i = 0;
+  for (auto _ : state) {
+    const Encoded &a = values[i];
+    if (++i == values.size()) i = 0;
+    const Encoded &b = values[i];
+    int result = compare(a.bytes, a.length, b.bytes, b.length);
+    benchmark::DoNotOptimize(result);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK_CAPTURE(BM_Compare, cidr/ipv4, &network_address::encode_cidr, &network_address::cmp_cidr, Corpus::kIPv4Networks);
+BENCHMARK_CAPTURE(BM_Compare, cidr/ipv6, &network_address::encode_cidr, &network_address::cmp_cidr, Corpus::kIPv6Networks);
+BENCHMARK_CAPTURE(BM_Compare, cidr/mixed, &network_address::encode_cidr, &network_address::cmp_cidr, Corpus::kMixedNetworks);
+BENCHMARK_CAPTURE(BM_Compare, inet/ipv4, &network_address::encode_inet, &network_address::cmp_inet, Corpus::kIPv4);
+BENCHMARK_CAPTURE(BM_Compare, inet/ipv6, &network_address::encode_inet, &network_address::cmp_inet, Corpus::kIPv6Compressed);
+BENCHMARK_CAPTURE(BM_Compare, inet/mixed, &network_address::encode_inet, &network_address::cmp_inet, Corpus::kMixed);
+BENCHMARK_CAPTURE(BM_Compare, inet4, &network_address::encode_inet4, &network_address::cmp_inet4, Corpus::kIPv4);
+BENCHMARK_CAPTURE(BM_Compare, inet6, &network_address::encode_inet6, &network_address::cmp_inet6, Corpus::kIPv6Compressed);
+BENCHMARK_CAPTURE(BM_Compare, macaddr, &network_address::encode_macaddr, &network_address::cmp_macaddr, Corpus::kMacColon);
+BENCHMARK_CAPTURE(BM_Compare, macaddr8, &network_address::encode_macaddr8, &network_address::cmp_macaddr8, Corpus::kMac8Colon);
+
+// ============================================================================
+// Sorting
+// ============================================================================
+
+// One stored IPv6 INET value, as it sits in a sort buffer
+struct SortRecord {
+  unsigned char bytes[sizeof(network_address::IPv6Network)];
+};
+
+// std::sort of N IPv6 values through cmp_inet, the comparator load of a
+// filesort or an index build. The high half of each address comes from the
+// corpus (a few real /32s, so most comparisons reach the low word) and the
+// low half is random. The 50M-row case needs about 1 GB of memory.
+void BM_SortIPv6(benchmark::State &state) {
+  const std::vector<Encoded> corpus = encode_corpus(
+      make_corpus(Corpus::kIPv6Compressed), &network_address::encode_inet);
+  std::vector<SortRecord> records(static_cast<size_t>(state.range(0)));
+  std::mt19937_64 rng(0x5eed0039u);
+  for (auto _ : state) {
+    state.PauseTiming();
+    for (size_t i = 0; i < records.size(); i++) {
+      const Encoded &v = corpus[i % corpus.size()];
+      memcpy(records[i].bytes, v.bytes, sizeof(records[i].bytes));
+      uint64_t low = rng();
+      memcpy(records[i].bytes + 8, &low, sizeof(low));
+    }
+    state.ResumeTiming();
+
+    std::sort(records.begin(), records.end(),
+              [](const SortRecord &a, const SortRecord &b) {
+                return network_address::cmp_inet(a.bytes, sizeof(a.bytes),
+                                                 b.bytes, sizeof(b.bytes)) < 0;
+              });
+    benchmark::DoNotOptimize(records.data());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_SortIPv6)->Arg(1 << 20)->Arg(50000000)->Unit(benchmark::kMillisecond);
+
+// ============================================================================
+// Mask helpers
+// ============================================================================
+
+void BM_NetmaskIPv4(benchmark::State &state) {
+  uint8_t prefix = 0;
+  for (auto _ : state) {
+    uint32_t mask = network_address::prefix_to_netmask_ipv4(prefix);
+    benchmark::DoNotOptimize(mask);
+    prefix = (prefix + 1) % 33;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_NetmaskIPv4);
+
+void BM_HostmaskIPv4(benchmark::State &state) {
+  uint8_t prefix = 0;
+  for (auto _ : state) {
+    uint32_t mask = network_address::prefix_to_hostmask_ipv4(prefix);
+    benchmark::DoNotOptimize(mask);
+    prefix = (prefix + 1) % 33;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_HostmaskIPv4);
+
+void BM_NetmaskIPv6(benchmark::State &state) {
+  uint8_t mask[16];
+  uint8_t prefix = 0;
+  for (auto _ : state) {
+    network_address::prefix_to_netmask_ipv6(prefix, mask);
+    benchmark::DoNotOptimize(mask);
+    prefix = (prefix + 1) % 129;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_NetmaskIPv6);
+
+void BM_HostmaskIPv6(benchmark::State &state) {
+  uint8_t mask[16];
+  uint8_t prefix = 0;
+  for (auto _ : state) {
+    network_address::prefix_to_hostmask_ipv6(prefix, mask);
+    benchmark::DoNotOptimize(mask);
+    prefix = (prefix + 1) % 129;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_HostmaskIPv6);
+
+// ============================================================================
+// Extractors
+// ============================================================================
+
+using IntExtractFn = int (*)(const unsigned char *, size_t);
+using TextExtractFn = bool (*)(const unsigned char *, size_t, char *, size_t,
+                               size_t *);
+using BinaryExtractFn = bool (*)(const unsigned char *, size_t,
+                                 unsigned char *, size_t *);
+
+void BM_ExtractInt(benchmark::State &state, IntExtractFn extract,
+                   Corpus kind) {
+  const std::vector<Encoded> values =
+      encode_corpus(make_corpus(kind), &network_address::encode_inet);
+  size_t i = 0;
+  for (auto _ : state) {
+    const Encoded &v = values[i];
+    int result = extract(v.bytes, v.length);
+    benchmark::DoNotOptimize(result);
+    if (++i == values.size()) i = 0;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+void BM_ExtractText(benchmark::State &state, EncodeFn encode,
+                    TextExtractFn extract, Corpus kind) {
+  const std::vector<Encoded> values = encode_corpus(make_corpus(kind), encode);
+  char text[64];
+  size_t length;
+  size_t i = 0;
+  for (auto _ : state) {
+    const Encoded &v = values[i];
+    bool error = extract(v.bytes, v.length, text, sizeof(text), &length);
+    benchmark::DoNotOptimize(error);
+    benchmark::DoNotOptimize(text);
+    if (++i == values.size()) i = 0;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+void BM_ExtractBinary(benchmark::State &state, BinaryExtractFn extract,
+                      Corpus kind) {
+  const std::vector<Encoded> values =
+      encode_corpus(make_corpus(kind), &network_address::encode_inet);
+  unsigned char result[sizeof(network_address::IPv6Network)];
+  size_t length;
+  size_t i = 0;
+  for (auto _ : state) {
+    const Encoded &v = values[i];
+    bool error = extract(v.bytes, v.length, result, &length);
+    benchmark::DoNotOptimize(error);
+    benchmark::DoNotOptimize(result);
+    if (++i == values.size()) i = 0;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK_CAPTURE(BM_ExtractInt, family/mixed, &network_address::inet_family, Corpus::kMixed);
+BENCHMARK_CAPTURE(BM_ExtractInt, masklen/mixed, &network_address::inet_masklen, Corpus::kMixed);
+BENCHMARK_CAPTURE(BM_ExtractText, host/mixed, &network_address::encode_inet, &network_address::inet_host, Corpus::kMixed);
+BENCHMARK_CAPTURE(BM_ExtractText, text/mixed, &network_address::encode_inet, &network_address::inet_text, Corpus::kMixed);
+BENCHMARK_CAPTURE(BM_ExtractText, inet_abbrev/mixed, &network_address::encode_inet, &network_address::inet_abbrev, Corpus::kMixed);
+BENCHMARK_CAPTURE(BM_ExtractText, cidr_abbrev/mixed, &network_address::encode_cidr, &network_address::cidr_abbrev, Corpus::kMixedNetworks);
+BENCHMARK_CAPTURE(BM_ExtractBinary, netmask/mixed, &network_address::inet_netmask, Corpus::kMixed);
+BENCHMARK_CAPTURE(BM_ExtractBinary, hostmask/mixed, &network_address::inet_hostmask, Corpus::kMixed);
+BENCHMARK_CAPTURE(BM_ExtractBinary, broadcast/mixed, &network_address::inet_broadcast, Corpus::kMixed);
+BENCHMARK_CAPTURE(BM_ExtractBinary, network/mixed, &network_address::inet_network, Corpus::kMixed);
+BENCHMARK_CAPTURE(BM_ExtractBinary, network/ipv4, &network_address::inet_network, Corpus::kIPv4);
+BENCHMARK_CAPTURE(BM_ExtractBinary, network/ipv6, &network_address::inet_network, Corpus::kIPv6Compressed);
+
+// ============================================================================
+// Modifiers
+// ============================================================================
+
+using SetMasklenFn = bool (*)(const unsigned char *, size_t, int,
+                              unsigned char *, size_t *);
+
+// set_masklen with the new masklen cycling through every length valid for
+// the value's family
+void BM_SetMasklen(benchmark::State &state, EncodeFn encode,
+                   SetMasklenFn set_masklen, Corpus kind) {
+  const std::vector<Encoded> values = encode_corpus(make_corpus(kind), encode);
+  unsigned char result[sizeof(network_address::IPv6Network)];
+  size_t length;
+  size_t i = 0;
+  int masklen = 0;
+  for (auto _ : state) {
+    const Encoded &v = values[i];
+    int max_masklen = v.length == sizeof(network_address::IPv4Network)
+                          ? network_address::IPV4_MAX_PREFIXLEN
+                          : network_address::IPV6_MAX_PREFIXLEN;
+    bool error = set_masklen(v.bytes, v.length, masklen % (max_masklen + 1),
+                             result, &length);
+    benchmark::DoNotOptimize(error);
+    benchmark::DoNotOptimize(result);
+    if (++i == values.size()) i = 0;
+    if (++masklen > network_address::IPV6_MAX_PREFIXLEN) masklen = 0;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK_CAPTURE(BM_SetMasklen, inet/mixed, &network_address::encode_inet, &network_address::inet_set_masklen, Corpus::kMixed);
+BENCHMARK_CAPTURE(BM_SetMasklen, cidr/mixed, &network_address::encode_cidr, &network_address::cidr_set_masklen, Corpus::kMixedNetworks);
+BENCHMARK_CAPTURE(BM_SetMasklen, cidr/ipv6, &network_address::encode_cidr, &network_address::cidr_set_masklen, Corpus::kIPv6Networks);
+
+void BM_MacaddrToBigint(benchmark::State &state) {
+  const std::vector<Encoded> values = encode_corpus(
+      make_corpus(Corpus::kMacColon), &network_address::encode_macaddr);
+  size_t i = 0;
+  for (auto _ : state) {
+    const Encoded &v = values[i];
+    long long value;
+    bool error = network_address::macaddr_to_bigint(v.bytes, v.length, &value);
+    benchmark::DoNotOptimize(error);
+    benchmark::DoNotOptimize(value);
+    if (++i == values.size()) i = 0;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_MacaddrToBigint);
+
+void BM_MacaddrFromBigint(benchmark::State &state) {
+  const std::vector<Encoded> values = encode_corpus(
+      make_corpus(Corpus::kMacColon), &network_address::encode_macaddr);
+  std::vector<long long> integers;
+  for (const Encoded &v : values) {
+    long long value;
+    network_address::macaddr_to_bigint(v.bytes, v.length, &value);
+    integers.push_back(value);
+  }
+  unsigned char result[sizeof(network_address::MacAddr)];
+  size_t length;
+  size_t i = 0;
+  for (auto _ : state) {
+    bool error =
+        network_address::macaddr_from_bigint(integers[i], result, &length);
+    benchmark::DoNotOptimize(error);
+    benchmark::DoNotOptimize(result);
+    if (++i == integers.size()) i = 0;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_MacaddrFromBigint);
+
+// ============================================================================
+// Containment and enumeration
+// ============================================================================
+
+// Containment of every corpus address in one fixed network, compiling the
+// network per call (uncached) or once through the per-thread memo (cached)
+void BM_Contains(benchmark::State &state, bool cached) {
+  const std::vector<Encoded> values =
+      encode_corpus(make_corpus(Corpus::kMixed), &network_address::encode_inet);
+  Encoded network;
+  const char kNetwork[] = "10.0.0.0/8";
+  network_address::encode_cidr(network.bytes, sizeof(network.bytes), kNetwork,
+                               sizeof(kNetwork) - 1, &network.length);
+  network_address::CompiledNetworkCache cache;
+  size_t i = 0;
+  for (auto _ : state) {
+    const Encoded &v = values[i];
+    int result;
+    if (cached) {
+      const network_address::CompiledNetwork *compiled =
+          cache.get(network.bytes, network.length);
+      result = network_address::network_includes(*compiled, v.bytes, v.length,
+                                                 false);
+    } else {
+      network_address::CompiledNetwork compiled;
+      network_address::compile_network(network.bytes, network.length,
+                                       &compiled);
+      result = network_address::network_includes(compiled, v.bytes, v.length,
+                                                 false);
+    }
+    benchmark::DoNotOptimize(result);
+    if (++i == values.size()) i = 0;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_CAPTURE(BM_Contains, uncached, false);
+BENCHMARK_CAPTURE(BM_Contains, cached, true);
+
+// Decompose ranges of increasing span into CIDR blocks
+void BM_RangeToCidrs(benchmark::State &state) {
+  const char *start_text = state.range(0) == 4 ? "10.0.0.1" : "2001:db8::1";
+  const char *end_text = state.range(0) == 4 ? "10.255.255.254"
+                                             : "2001:db8:ffff:ffff:ffff:ffff:ffff:fffe";
+  Encoded start, end;
+  network_address::encode_inet(start.bytes, sizeof(start.bytes), start_text,
+                               strlen(start_text), &start.length);
+  network_address::encode_inet(end.bytes, sizeof(end.bytes), end_text,
+                               strlen(end_text), &end.length);
+  std::vector<char> result(65536);
+  size_t length;
+  for (auto _ : state) {
+    bool error = network_address::inet_range_to_cidrs(
+        start.bytes, start.length, end.bytes, end.length, result.data(),
+        result.size(), &length);
+    benchmark::DoNotOptimize(error);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_RangeToCidrs)->Arg(4)->Arg(6);
+
+// ============================================================================
+// Call statistics
+// ============================================================================
+
+#if NETWORK_ADDRESS_STATS
+// What netaddr_stats() adds to each SQL call: a comparison (the cheapest
+// call, as in inet_compare()) and a parse, bare (0) and inside the
+// StatScope the extension puts around every call (1)
+void BM_StatScopeCompare(benchmark::State &state) {
+  const std::vector<Encoded> values =
+      encode_corpus(make_corpus(Corpus::kMixed), &network_address::encode_inet);
+  const int function = network_address::register_stat_function("bench.compare");
+  const bool scoped = state.range(0) != 0;
+  size_t i = 0;
+  for (auto _ : state) {
+    const Encoded &a = values[i];
+    if (++i == values.size()) i = 0;
+    const Encoded &b = values[i];
+    int result;
+    if (scoped) {
+      network_address::StatScope scope(function, false);
+      result = network_address::cmp_inet(a.bytes, a.length, b.bytes, b.length);
+    } else {
+      result = network_address::cmp_inet(a.bytes, a.length, b.bytes, b.length);
+    }
+    benchmark::DoNotOptimize(result);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_StatScopeCompare)->Arg(0)->Arg(1);
+
+void BM_StatScopeEncode(benchmark::State &state) {
+  const std::vector<std::string> corpus = make_corpus(Corpus::kMixed);
+  const int function = network_address::register_stat_function("bench.encode");
+  const bool scoped = state.range(0) != 0;
+  unsigned char buffer[sizeof(network_address::IPv6Network)];
+  size_t length;
+  size_t i = 0;
+  for (auto _ : state) {
+    const std::string &s = corpus[i];
+    bool error;
+    if (scoped) {
+      network_address::StatScope scope(function, false);
+      error = network_address::encode_inet(buffer, sizeof(buffer), s.data(),
+                                           s.size(), &length);
+    } else {
+      error = network_address::encode_inet(buffer, sizeof(buffer), s.data(),
+                                           s.size(), &length);
+    }
+    benchmark::DoNotOptimize(error);
+    benchmark::DoNotOptimize(buffer);
+    if (++i == corpus.size()) i = 0;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_StatScopeEncode)->Arg(0)->Arg(1);
+#endif
+
+} // namespace
+
+// The report's context names the kernel set that ran; run with
+// VSQL_NETWORK_ADDRESS_FORCE_SCALAR=1 to measure the scalar kernels.
+int main(int argc, char **argv) {
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::AddCustomContext("kernels", network_address::kernel_set());
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+  return 0;
+}
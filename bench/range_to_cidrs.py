@@ -0,0 +1,55 @@
+#!/usr/bin/env python3
+# Copyright (c) 2026 VillageSQL Contributors
+#
+# This program is free software; you can redistribute it and/or
+# modify it under the terms of the GNU General Public License
+# as published by the Free Software Foundation; either version 2
+# of the License, or (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, see <https://www.gnu.org/licenses/>.
+
+"""Times Python's ipaddress.summarize_address_range on the ranges of
+BM_RangeToCidrs, producing the same JSON text as inet_range_to_cidrs, so
+the two can be compared side by side:
+
+    python3 bench/range_to_cidrs.py
+    network_address_bench --benchmark_filter=BM_RangeToCidrs
+"""
+
+import ipaddress
+import json
+import timeit
+
+# The same ranges as BM_RangeToCidrs/4 and BM_RangeToCidrs/6
+RANGES = {
+    4: ("10.0.0.1", "10.255.255.254"),
+    6: ("2001:db8::1", "2001:db8:ffff:ffff:ffff:ffff:ffff:fffe"),
+}
+
+
+def range_to_cidrs(first, last):
+    return json.dumps(
+        [str(net) for net in ipaddress.summarize_address_range(first, last)],
+        separators=(",", ":"))
+
+
+def main():
+    print("range\tblocks\tns_per_range")
+    for family, (first_text, last_text) in RANGES.items():
+        first = ipaddress.ip_address(first_text)
+        last = ipaddress.ip_address(last_text)
+        blocks = len(json.loads(range_to_cidrs(first, last)))
+        timer = timeit.Timer(lambda: range_to_cidrs(first, last))
+        loops, _ = timer.autorange()
+        best = min(timer.repeat(repeat=5, number=loops)) / loops
+        print(f"BM_RangeToCidrs/{family}\t{blocks}\t{best * 1e9:.0f}")
+
+
+if __name__ == "__main__":
+    main()
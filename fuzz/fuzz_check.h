@@ -0,0 +1,72 @@
+/* Copyright (c) 2026 VillageSQL Contributors
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <https://www.gnu.org/licenses/>.
+ */
+
+// Shared by the fuzz targets: the encoder table and a check that reports
+// the offending input before aborting, so libFuzzer saves it as a crash.
+
+#ifndef NETWORK_ADDRESS_FUZZ_CHECK_H
+#define NETWORK_ADDRESS_FUZZ_CHECK_H
+
+#include <cstdio>
+#include <cstdlib>
+
+#include "network_address_core.h"
+
+namespace network_address_fuzz {
+
+using EncodeFn = bool (*)(unsigned char *, size_t, const char *, size_t,
+                          size_t *);
+using DecodeFn = bool (*)(const unsigned char *, size_t, char *, size_t,
+                          size_t *);
+
+struct Codec {
+  const char *name;
+  EncodeFn encode;
+  DecodeFn decode;
+};
+
+constexpr Codec kCodecs[] = {
+    {"cidr", network_address::encode_cidr, network_address::decode_cidr},
+    {"inet", network_address::encode_inet, network_address::decode_inet},
+    {"macaddr", network_address::encode_macaddr,
+     network_address::decode_macaddr},
+    {"macaddr8", network_address::encode_macaddr8,
+     network_address::decode_macaddr8},
+    {"inet4", network_address::encode_inet4, network_address::decode_inet4},
+    {"inet6", network_address::encode_inet6, network_address::decode_inet6},
+};
+
+// Large enough for any stored value and any formatted text
+constexpr size_t kValueBytes = 32;
+constexpr size_t kTextBytes = 128;
+
+[[noreturn]] inline void fail(const char *codec, const char *what,
+                              const char *text, size_t text_len) {
+  fprintf(stderr, "%s: %s for input '%.*s' (%zu bytes)\n", codec, what,
+          static_cast<int>(text_len), text, text_len);
+  abort();
+}
+
+} // namespace network_address_fuzz
+
+#define FUZZ_CHECK(condition, codec, what, text, text_len)         \
+  do {                                                             \
+    if (!(condition)) {                                            \
+      network_address_fuzz::fail(codec, what, text, text_len);     \
+    }                                                              \
+  } while (0)
+
+#endif // NETWORK_ADDRESS_FUZZ_CHECK_H
@@ -0,0 +1,47 @@
+# Runs each fuzz target for SECONDS and collects libFuzzer's final stats.
+#
+#   cmake -DFUZZERS=a,b -DSEEDS=dir -DDICT=file -DSECONDS=n
+#         -DWORK_DIR=dir -DREPORT=file -P fuzz_report.cmake
+#
+# Each target grows its own corpus under WORK_DIR (the checked-in seeds are
+# only read) and logs to WORK_DIR/<target>.log. A crash stops the report.
+
+string(REPLACE "," ";" fuzzers "${FUZZERS}")
+file(WRITE "${REPORT}" "target\truns\texecs_per_sec\tnew_units\tpeak_rss_mb\n")
+
+foreach(fuzzer IN LISTS fuzzers)
+    get_filename_component(name "${fuzzer}" NAME)
+    set(corpus "${WORK_DIR}/${name}")
+    set(log "${WORK_DIR}/${name}.log")
+    file(MAKE_DIRECTORY "${corpus}")
+
+    execute_process(
+        COMMAND "${fuzzer}" "${corpus}" "${SEEDS}"
+                -dict=${DICT}
+                -max_total_time=${SECONDS}
+                -print_final_stats=1
+                -artifact_prefix=${WORK_DIR}/${name}-
+        RESULT_VARIABLE result
+        OUTPUT_FILE "${log}"
+        ERROR_FILE "${log}"
+    )
+    if(NOT result EQUAL 0)
+        message(FATAL_ERROR "${name} failed (exit ${result}); see ${log}")
+    endif()
+
+    file(READ "${log}" output)
+    set(stats "")
+    foreach(stat number_of_executed_units average_exec_per_sec
+                 new_units_added peak_rss_mb)
+        if(output MATCHES "stat::${stat}: *([0-9]+)")
+            list(APPEND stats "${CMAKE_MATCH_1}")
+        else()
+            list(APPEND stats "?")
+        endif()
+    endforeach()
+    list(JOIN stats "\t" row)
+    file(APPEND "${REPORT}" "${name}\t${row}\n")
+
+    list(GET stats 1 execs_per_sec)
+    message(STATUS "${name}: ${execs_per_sec} execs/sec")
+endforeach()
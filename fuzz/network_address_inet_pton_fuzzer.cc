@@ -0,0 +1,150 @@
+/* Copyright (c) 2026 VillageSQL Contributors
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <https://www.gnu.org/licenses/>.
+ */
+
+// The address parsers must accept exactly what glibc's inet_pton accepts,
+// with the same bytes, apart from two documented differences: IPv4 octets
+// may carry leading zeros ("010" is ten), and IPv6 text with a dotted IPv4
+// tail is not supported. encode_inet must accept "address/masklen" exactly
+// when the address does and masklen is one to three digits in range.
+
+#include <arpa/inet.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#include "fuzz_check.h"
+
+namespace {
+
+// text with leading zeros dropped from every octet of one to three digits,
+// which inet_pton would otherwise reject
+std::string without_octet_zeros(const std::string &text) {
+  std::string result;
+  size_t start = 0;
+  while (true) {
+    size_t end = text.find('.', start);
+    if (end == std::string::npos) end = text.size();
+    std::string octet = text.substr(start, end - start);
+    if (!octet.empty() && octet.size() <= 3 &&
+        octet.find_first_not_of("0123456789") == std::string::npos) {
+      octet.erase(0, std::min(octet.find_first_not_of('0'), octet.size() - 1));
+    }
+    result += octet;
+    if (end == text.size()) return result;
+    result += '.';
+    start = end + 1;
+  }
+}
+
+// inet_pton's verdict on text as INET: the family, or 0 if it rejects it
+int pton_family(const std::string &text, uint8_t *address) {
+  if (inet_pton(AF_INET, without_octet_zeros(text).c_str(), address) == 1) {
+    return network_address::AF_INET_VAL;
+  }
+  if (text.find('.') == std::string::npos &&
+      inet_pton(AF_INET6, text.c_str(), address) == 1) {
+    return network_address::AF_INET6_VAL;
+  }
+  return 0;
+}
+
+void check_parsers(const std::string &text) {
+  const char *input = text.c_str();
+  const size_t size = text.size();
+
+  uint32_t ours4 = 0;
+  uint8_t theirs4[4];
+  const bool accepted4 = network_address::parse_ipv4_address(input, &ours4);
+  const bool pton4 =
+      inet_pton(AF_INET, without_octet_zeros(text).c_str(), theirs4) == 1;
+  FUZZ_CHECK(accepted4 == pton4, "ipv4",
+             accepted4 ? "accepted, inet_pton rejects"
+                       : "rejected, inet_pton accepts",
+             input, size);
+  const uint32_t network4 = htonl(ours4);
+  FUZZ_CHECK(!accepted4 || memcmp(&network4, theirs4, 4) == 0, "ipv4",
+             "bytes differ from inet_pton", input, size);
+
+  uint8_t ours6[16];
+  uint8_t theirs6[16];
+  const bool accepted6 = network_address::parse_ipv6_address(input, ours6);
+  const bool pton6 = inet_pton(AF_INET6, input, theirs6) == 1;
+  const bool dotted = text.find('.') != std::string::npos;
+  FUZZ_CHECK(accepted6 == pton6 || (dotted && !accepted6), "ipv6",
+             accepted6 ? "accepted, inet_pton rejects"
+                       : "rejected, inet_pton accepts",
+             input, size);
+  FUZZ_CHECK(!accepted6 || memcmp(ours6, theirs6, 16) == 0, "ipv6",
+             "bytes differ from inet_pton", input, size);
+}
+
+void check_inet_prefix(const std::string &text) {
+  const size_t slash = text.find('/');
+  const std::string address_text = text.substr(0, slash);
+  uint8_t address[16];
+  const int family = pton_family(address_text, address);
+  bool expected = family != 0;
+  int masklen = family == network_address::AF_INET_VAL ? 32 : 128;
+  if (slash != std::string::npos) {
+    const std::string digits = text.substr(slash + 1);
+    expected = expected && !digits.empty() && digits.size() <= 3 &&
+               digits.find_first_not_of("0123456789") == std::string::npos;
+    if (expected) {
+      masklen = std::stoi(digits);
+      expected = masklen <= (family == network_address::AF_INET_VAL ? 32 : 128);
+    }
+  }
+
+  unsigned char value[network_address_fuzz::kValueBytes];
+  size_t value_len = 0;
+  const bool accepted = !network_address::encode_inet(
+      value, sizeof(value), text.data(), text.size(), &value_len);
+  FUZZ_CHECK(accepted == expected, "inet",
+             accepted ? "accepted invalid text" : "rejected valid text",
+             text.data(), text.size());
+  if (!accepted) {
+    return;
+  }
+  // The IPv4 address is stored as a host-order integer
+  const bool ipv4 = family == network_address::AF_INET_VAL;
+  uint32_t stored4;
+  memcpy(&stored4, value, sizeof(stored4));
+  stored4 = htonl(stored4);
+  FUZZ_CHECK(value_len == (ipv4 ? sizeof(network_address::IPv4Network)
+                                : sizeof(network_address::IPv6Network)) &&
+                 memcmp(ipv4 ? reinterpret_cast<unsigned char *>(&stored4)
+                             : value,
+                        address, ipv4 ? 4 : 16) == 0 &&
+                 value[ipv4 ? 4 : 16] == masklen,
+             "inet", "value differs from inet_pton", text.data(),
+             text.size());
+}
+
+} // namespace
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+  // inet_pton stops at a NUL; the encoders are given the same text
+  if (memchr(data, '\0', size) != nullptr ||
+      size >= network_address::kMaxInputString) {
+    return 0;
+  }
+  const std::string text(reinterpret_cast<const char *>(data), size);
+  check_parsers(text);
+  check_inet_prefix(text);
+  return 0;
+}
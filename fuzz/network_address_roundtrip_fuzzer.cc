@@ -0,0 +1,101 @@
+/* Copyright (c) 2026 VillageSQL Contributors
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <https://www.gnu.org/licenses/>.
+ */
+
+// Every input is parsed as each type. Whatever parses must format, and the
+// formatted text must parse back to the same bytes and format to the same
+// text again (encode -> decode -> encode is idempotent). The parse and
+// format caches must not change any of the results.
+
+#include <cstdint>
+#include <cstring>
+
+#include "fuzz_check.h"
+
+using network_address_fuzz::Codec;
+using network_address_fuzz::kCodecs;
+using network_address_fuzz::kTextBytes;
+using network_address_fuzz::kValueBytes;
+
+namespace {
+
+void check_round_trip(const Codec &codec, const char *text, size_t size) {
+  unsigned char value[kValueBytes];
+  size_t value_len = 0;
+  const bool rejected =
+      codec.encode(value, sizeof(value), text, size, &value_len);
+
+  network_address::set_parse_cache_enabled(true);
+  for (int pass = 0; pass < 2; ++pass) {  // A miss, then a hit
+    unsigned char cached[kValueBytes];
+    size_t cached_len = 0;
+    const bool cached_rejected =
+        codec.encode(cached, sizeof(cached), text, size, &cached_len);
+    FUZZ_CHECK(cached_rejected == rejected &&
+                   (rejected || (cached_len == value_len &&
+                                 memcmp(cached, value, value_len) == 0)),
+               codec.name, "parse cache changed the result", text, size);
+  }
+  network_address::set_parse_cache_enabled(false);
+  if (rejected) {
+    return;
+  }
+
+  char formatted[kTextBytes];
+  size_t formatted_len = 0;
+  FUZZ_CHECK(!codec.decode(value, value_len, formatted, sizeof(formatted),
+                           &formatted_len),
+             codec.name, "parsed value does not format", text, size);
+
+  unsigned char reparsed[kValueBytes];
+  size_t reparsed_len = 0;
+  FUZZ_CHECK(!codec.encode(reparsed, sizeof(reparsed), formatted,
+                           formatted_len, &reparsed_len),
+             codec.name, "formatted text does not parse", formatted,
+             formatted_len);
+  FUZZ_CHECK(reparsed_len == value_len &&
+                 memcmp(reparsed, value, value_len) == 0,
+             codec.name, "formatted text parses to other bytes", text, size);
+
+  char reformatted[kTextBytes];
+  size_t reformatted_len = 0;
+  FUZZ_CHECK(!codec.decode(reparsed, reparsed_len, reformatted,
+                           sizeof(reformatted), &reformatted_len) &&
+                 reformatted_len == formatted_len &&
+                 memcmp(reformatted, formatted, formatted_len) == 0,
+             codec.name, "formatting is not stable", text, size);
+
+  network_address::set_format_cache_enabled(true);
+  for (int pass = 0; pass < 2; ++pass) {
+    char cached[kTextBytes];
+    size_t cached_len = 0;
+    FUZZ_CHECK(!codec.decode(value, value_len, cached, sizeof(cached),
+                             &cached_len) &&
+                   cached_len == formatted_len &&
+                   memcmp(cached, formatted, formatted_len) == 0,
+               codec.name, "format cache changed the text", text, size);
+  }
+  network_address::set_format_cache_enabled(false);
+}
+
+} // namespace
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+  const char *text = reinterpret_cast<const char *>(data);
+  for (const Codec &codec : kCodecs) {
+    check_round_trip(codec, text, size);
+  }
+  return 0;
+}
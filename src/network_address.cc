@@ -16,1687 +16,1027 @@
 
 #include <villagesql/vsql.h>
 
-#include <cassert>
-#include <cctype>
 #include <cstddef>
 #include <cstdint>
+#include <cstdio>
 #include <cstdlib>
 #include <cstring>
-#include <stdio.h>
 #include <string>
+#include <string_view>
+
+#include "network_address_core.h"
 
 using namespace ::vsql;
 
-namespace network_address {
-
-// Data structure definitions for network address types
-
-// IPv4 network address structure (7 bytes total)
-struct IPv4Network {
-  uint32_t address;  // 4 bytes - network byte order
-  uint8_t netmask;   // 1 byte - CIDR prefix length
-  uint8_t family;    // 1 byte - address family (2 for IPv4)
-  uint8_t flags;     // 1 byte - type flags (CIDR vs INET)
-};
-
-// IPv6 network address structure (19 bytes total)
-struct IPv6Network {
-  uint8_t address[16]; // 16 bytes - IPv6 address
-  uint8_t netmask;     // 1 byte - CIDR prefix length
-  uint8_t family;      // 1 byte - address family (10 for IPv6)
-  uint8_t flags;       // 1 byte - type flags (CIDR vs INET)
-};
-
-// MAC address structure (6 bytes)
-struct MacAddr {
-  uint8_t address[6];  // 6 bytes - MAC address
-};
-
-// Extended MAC address structure (8 bytes)
-struct MacAddr8 {
-  uint8_t address[8];  // 8 bytes - EUI-64 MAC address
-};
-
-// Constants
-static constexpr uint8_t ADDR_FLAG_CIDR = 0x01;  // Strict CIDR validation
-static constexpr uint8_t ADDR_FLAG_INET = 0x02;  // INET allows host bits
-static constexpr uint8_t AF_INET_VAL = 2;        // IPv4 family
-static constexpr uint8_t AF_INET6_VAL = 10;      // IPv6 family
-static constexpr uint8_t IPV4_MAX_PREFIXLEN = 32;
-static constexpr uint8_t IPV6_MAX_PREFIXLEN = 128;
-
-// Maximum string lengths for display
-static constexpr size_t kMaxIPv4String = 18;   // xxx.xxx.xxx.xxx/32
-static constexpr size_t kMaxIPv6String = 44;   // full IPv6 with /128 + null
-static constexpr size_t kMaxMacAddrString = 17; // xx:xx:xx:xx:xx:xx
-static constexpr size_t kMaxMacAddr8String = 23; // xx:xx:xx:xx:xx:xx:xx:xx
-
-// Helper functions for parsing network addresses
-
-// Parse IPv4 address string "192.168.1.1" into uint32_t
-bool parse_ipv4_address(const char* addr_str, uint32_t* address) {
-  unsigned int a, b, c, d;
-  if (sscanf(addr_str, "%u.%u.%u.%u", &a, &b, &c, &d) != 4) {
-    return false;
-  }
-  if (a > 255 || b > 255 || c > 255 || d > 255) {
-    return false;
-  }
-  // Store in network byte order
-  *address = (a << 24) | (b << 16) | (c << 8) | d;
-  return true;
-}
+// =============================================================================
+// Call statistics
+// =============================================================================
 
-// Format IPv4 address from uint32_t to string
-void format_ipv4_address(uint32_t address, char* buffer, size_t buffer_size) {
-  snprintf(buffer, buffer_size, "%u.%u.%u.%u",
-           (address >> 24) & 0xFF,
-           (address >> 16) & 0xFF,
-           (address >> 8) & 0xFF,
-           address & 0xFF);
+// NETADDR_STAT_SCOPE(name, args...) at the top of a VDF or type callback
+// counts the call under name in netaddr_stats(), as a NULL call if any of
+// args is NULL, and as a parse failure if the core rejects text during it.
+// Empty unless the extension is built with -DNETWORK_ADDRESS_STATS=ON.
+// The types' compare callbacks carry no scope: they run once per pair in
+// every sort and index search, where a scope would triple their cost.
+#if NETWORK_ADDRESS_STATS
+template <class Arg>
+static bool stat_null_arg(const Arg &arg) {
+  return arg.is_null();
 }
 
-// Parse IPv6 address string with :: compression support
-bool parse_ipv6_address(const char* addr_str, uint8_t* address) {
-  if (addr_str == nullptr || address == nullptr) {
-    return false;
-  }
-
-  // Initialize address to zeros
-  memset(address, 0, 16);
-
-  // Find :: if present (marks compression point)
-  const char *double_colon = strstr(addr_str, "::");
-
-  if (double_colon != nullptr) {
-    // Parse left side of ::
-    int left_parts = 0;
-    uint16_t left_values[8];
-
-    if (double_colon != addr_str) {
-      // There are parts before ::
-      std::string left_str(addr_str, double_colon - addr_str);
-      const char *p = left_str.c_str();
-      while (*p && left_parts < 8) {
-        char *end;
-        unsigned long val = strtoul(p, &end, 16);
-        if (val > 0xFFFF || p == end) {
-          return false;
-        }
-        left_values[left_parts++] = static_cast<uint16_t>(val);
-        if (*end == ':') {
-          p = end + 1;
-        } else if (*end == '\0') {
-          break;
-        } else {
-          return false;
-        }
-      }
-    }
-
-    // Parse right side of ::
-    int right_parts = 0;
-    uint16_t right_values[8];
-    const char *right_start = double_colon + 2;
-
-    if (*right_start != '\0') {
-      const char *p = right_start;
-      while (*p && right_parts < 8) {
-        char *end;
-        unsigned long val = strtoul(p, &end, 16);
-        if (val > 0xFFFF || p == end) {
-          return false;
-        }
-        right_values[right_parts++] = static_cast<uint16_t>(val);
-        if (*end == ':') {
-          p = end + 1;
-        } else if (*end == '\0') {
-          break;
-        } else {
-          return false;
-        }
-      }
-    }
-
-    // Validate total parts don't exceed 8
-    if (left_parts + right_parts > 7) {
-      return false;
-    }
-
-    // Fill in the address
-    for (int i = 0; i < left_parts; i++) {
-      address[i * 2] = (left_values[i] >> 8) & 0xFF;
-      address[i * 2 + 1] = left_values[i] & 0xFF;
-    }
-
-    int right_start_index = 8 - right_parts;
-    for (int i = 0; i < right_parts; i++) {
-      int idx = right_start_index + i;
-      address[idx * 2] = (right_values[i] >> 8) & 0xFF;
-      address[idx * 2 + 1] = right_values[i] & 0xFF;
-    }
-
-  } else {
-    // No :: compression, must have exactly 8 parts
-    uint16_t parts[8];
-    const char *p = addr_str;
-    int part_count = 0;
-
-    while (*p && part_count < 8) {
-      char *end;
-      unsigned long val = strtoul(p, &end, 16);
-      if (val > 0xFFFF || p == end) {
-        return false;
-      }
-      parts[part_count++] = static_cast<uint16_t>(val);
-      if (*end == ':') {
-        p = end + 1;
-      } else if (*end == '\0') {
-        break;
-      } else {
-        return false;
-      }
-    }
-
-    if (part_count != 8) {
-      return false;
-    }
-
-    for (int i = 0; i < 8; i++) {
-      address[i * 2] = (parts[i] >> 8) & 0xFF;
-      address[i * 2 + 1] = parts[i] & 0xFF;
-    }
-  }
-
-  return true;
-}
+static bool stat_null_arg(std::string_view) { return false; }
 
-// Format IPv6 address to string
-void format_ipv6_address(const uint8_t* address, char* buffer, size_t buffer_size) {
-  snprintf(buffer, buffer_size, "%02x%02x:%02x%02x:%02x%02x:%02x%02x:%02x%02x:%02x%02x:%02x%02x:%02x%02x",
-           address[0], address[1], address[2], address[3],
-           address[4], address[5], address[6], address[7],
-           address[8], address[9], address[10], address[11],
-           address[12], address[13], address[14], address[15]);
+template <class... Args>
+static bool stat_any_null(const Args &...args) {
+  return (false || ... || stat_null_arg(args));
 }
 
-// Parse MAC address string "08:00:2b:01:02:03"
-bool parse_mac_address(const char* mac_str, uint8_t* address, int expected_bytes) {
-  if (mac_str == nullptr || address == nullptr) {
-    return false;
-  }
-
-  std::string cleaned;
-  cleaned.reserve(expected_bytes * 2);
-
-  for (const char *cursor = mac_str; *cursor != '\0'; ++cursor) {
-    unsigned char ch = static_cast<unsigned char>(*cursor);
-    if (std::isxdigit(ch)) {
-      cleaned.push_back(static_cast<char>(std::tolower(ch)));
-    } else if (ch == ':' || ch == '-' || ch == '.') {
-      continue; // Accept common separators
-    } else {
-      return false; // Reject unexpected characters early
-    }
-  }
+#define NETADDR_STAT_SCOPE(name, ...)                                       \
+  static const int netaddr_stat_id =                                        \
+      network_address::register_stat_function(name);                        \
+  network_address::StatScope netaddr_stat_scope(netaddr_stat_id,            \
+                                                stat_any_null(__VA_ARGS__))
+#else
+#define NETADDR_STAT_SCOPE(name, ...) \
+  do {                                \
+  } while (0)
+#endif
 
-  if (static_cast<int>(cleaned.size()) != expected_bytes * 2) {
-    return false;
-  }
+// =============================================================================
+// VEF Registration
+// =============================================================================
 
-  for (int i = 0; i < expected_bytes; ++i) {
-    unsigned int value = 0;
-    if (sscanf(cleaned.substr(i * 2, 2).c_str(), "%02x", &value) != 1) {
-      return false;
-    }
-    address[i] = static_cast<uint8_t>(value & 0xFF);
-  }
+// Type name constants (array form required for make_type<> template parameter)
+static constexpr const char kCidrTypeName[] = "CIDR";
+static constexpr const char kInetTypeName[] = "INET";
+static constexpr const char kMacaddrTypeName[] = "MACADDR";
+static constexpr const char kMacaddr8TypeName[] = "MACADDR8";
+static constexpr const char kInet4TypeName[] = "INET4";
+static constexpr const char kInet6TypeName[] = "INET6";
 
-  return true;
-}
+// =============================================================================
+// Typed encode/decode/compare wrappers for each type
+// These thin wrappers call into the raw-buffer implementations in
+// network_address_core.cc.
+// They serve as both the type's encode/decode/compare functions and the
+// user-callable cidr_from_string / cidr_to_string VDFs.
+// =============================================================================
 
-// Format MAC address to string
-void format_mac_address(const uint8_t* address, char* buffer, size_t buffer_size, int bytes) {
-  if (bytes == 6) {
-    snprintf(buffer, buffer_size, "%02x:%02x:%02x:%02x:%02x:%02x",
-             address[0], address[1], address[2], address[3], address[4], address[5]);
-  } else if (bytes == 8) {
-    snprintf(buffer, buffer_size, "%02x:%02x:%02x:%02x:%02x:%02x:%02x:%02x",
-             address[0], address[1], address[2], address[3],
-             address[4], address[5], address[6], address[7]);
+// --- CIDR ---
+void encode_cidr(std::string_view from, CustomResult out) {
+  NETADDR_STAT_SCOPE("CIDR.from_string", from);
+  auto buf = out.buffer();
+  size_t length;
+  if (network_address::encode_cidr(
+          buf.data(), buf.size(),
+          from.data(), from.size(), &length)) {
+    out.error("invalid CIDR address");
+    return;
   }
+  out.set_length(length);
 }
 
-// Validate CIDR network address (no host bits set)
-bool validate_cidr_network(uint32_t address, uint8_t netmask) {
-  if (netmask > IPV4_MAX_PREFIXLEN) return false;
-  if (netmask == 0) return true;
-
-  uint32_t mask = ~((1u << (IPV4_MAX_PREFIXLEN - netmask)) - 1);
-  return (address & ~mask) == 0;
-}
-
-// Validate IPv6 CIDR network address (no host bits set)
-bool validate_cidr_network_ipv6(const uint8_t *address, uint8_t netmask) {
-  if (netmask > IPV6_MAX_PREFIXLEN)
-    return false;
-  if (netmask == 0)
-    return true;
-
-  // Check that all host bits are zero
-  int full_bytes = netmask / 8;
-  int remaining_bits = netmask % 8;
-
-  // Check partial byte if exists
-  if (remaining_bits > 0) {
-    uint8_t mask = 0xFF << (8 - remaining_bits);
-    if ((address[full_bytes] & ~mask) != 0) {
-      return false;
-    }
-    full_bytes++;
+void decode_cidr(CustomArg in, StringResult out) {
+  NETADDR_STAT_SCOPE("cidr_to_string", in);
+  if (in.is_null()) {
+    out.set_null();
+    return;
   }
-
-  // Check remaining bytes are all zero
-  for (int i = full_bytes; i < 16; i++) {
-    if (address[i] != 0) {
-      return false;
-    }
+  auto span = in.value();
+  auto buf = out.buffer();
+  size_t length;
+  if (network_address::decode_cidr(
+          span.data(), span.size(),
+          buf.data(), buf.size(), &length)) {
+    out.warning("CIDR decode error");
+    return;
   }
-
-  return true;
+  out.set_length(length);
 }
 
-// Encoding/decoding functions for each type
-
-namespace {
+int cmp_cidr(CustomArg a, CustomArg b) {
+  auto sa = a.value(), sb = b.value();
+  return network_address::cmp_cidr(
+      sa.data(), sa.size(),
+      sb.data(), sb.size());
+}
 
-bool MarkInvalid(size_t *length) {
-  if (length != nullptr) {
-    *length = 0;
+// --- INET ---
+void encode_inet(std::string_view from, CustomResult out) {
+  NETADDR_STAT_SCOPE("INET.from_string", from);
+  auto buf = out.buffer();
+  size_t length;
+  if (network_address::encode_inet(
+          buf.data(), buf.size(),
+          from.data(), from.size(), &length)) {
+    out.error("invalid INET address");
+    return;
   }
-  return true;
+  out.set_length(length);
 }
 
-} // namespace
-
-bool encode_cidr(unsigned char *buffer, size_t buffer_size, const char *from, size_t from_len, size_t *length) {
-  if (buffer_size < sizeof(IPv4Network) || nullptr == buffer) {
-    return true;
+void decode_inet(CustomArg in, StringResult out) {
+  NETADDR_STAT_SCOPE("inet_to_string", in);
+  if (in.is_null()) {
+    out.set_null();
+    return;
   }
-
-  std::string from_str(from, from_len);
-  char addr_str[64];
-  int netmask;
-
-  if (sscanf(from_str.c_str(), "%63[^/]/%d", addr_str, &netmask) != 2) {
-    return MarkInvalid(length); // Parse error
+  auto span = in.value();
+  auto buf = out.buffer();
+  size_t length;
+  if (network_address::decode_inet(
+          span.data(), span.size(),
+          buf.data(), buf.size(), &length)) {
+    out.warning("INET decode error");
+    return;
   }
+  out.set_length(length);
+}
 
-  // Try IPv4 first
-  IPv4Network net4;
-  if (parse_ipv4_address(addr_str, &net4.address)) {
-    if (netmask < 0 || netmask > IPV4_MAX_PREFIXLEN) {
-      return MarkInvalid(length);
-    }
-
-    net4.netmask = static_cast<uint8_t>(netmask);
-    net4.family = AF_INET_VAL;
-    net4.flags = ADDR_FLAG_CIDR;
-
-    // CIDR requires strict network validation
-    if (!validate_cidr_network(net4.address, net4.netmask)) {
-      return MarkInvalid(length); // Invalid network address for CIDR
-    }
+int cmp_inet(CustomArg a, CustomArg b) {
+  auto sa = a.value(), sb = b.value();
+  return network_address::cmp_inet(
+      sa.data(), sa.size(),
+      sb.data(), sb.size());
+}
 
-    memcpy(buffer, &net4, sizeof(IPv4Network));
-    *length = sizeof(IPv4Network);
-    return false;
+// --- MACADDR ---
+void encode_macaddr(std::string_view from, CustomResult out) {
+  NETADDR_STAT_SCOPE("MACADDR.from_string", from);
+  auto buf = out.buffer();
+  size_t length;
+  if (network_address::encode_macaddr(
+          buf.data(), buf.size(),
+          from.data(), from.size(), &length)) {
+    out.error("invalid MAC address");
+    return;
   }
+  out.set_length(length);
+}
 
-  // Try IPv6
-  if (buffer_size < sizeof(IPv6Network)) {
-    return true;
+void decode_macaddr(CustomArg in, StringResult out) {
+  NETADDR_STAT_SCOPE("macaddr_to_string", in);
+  if (in.is_null()) {
+    out.set_null();
+    return;
   }
-
-  IPv6Network net6;
-  if (parse_ipv6_address(addr_str, net6.address)) {
-    if (netmask < 0 || netmask > IPV6_MAX_PREFIXLEN) {
-      return MarkInvalid(length);
-    }
-
-    net6.netmask = static_cast<uint8_t>(netmask);
-    net6.family = AF_INET6_VAL;
-    net6.flags = ADDR_FLAG_CIDR;
-
-    // CIDR requires strict network validation
-    if (!validate_cidr_network_ipv6(net6.address, net6.netmask)) {
-      return MarkInvalid(length); // Invalid network address for CIDR
-    }
-
-    memcpy(buffer, &net6, sizeof(IPv6Network));
-    *length = sizeof(IPv6Network);
-    return false;
+  auto span = in.value();
+  auto buf = out.buffer();
+  size_t length;
+  if (network_address::decode_macaddr(
+          span.data(), span.size(),
+          buf.data(), buf.size(), &length)) {
+    out.warning("MACADDR decode error");
+    return;
   }
-
-  return MarkInvalid(length); // Invalid address format
+  out.set_length(length);
 }
 
-bool decode_cidr(const unsigned char *buffer, size_t buffer_size, char *to, size_t to_size, size_t *to_length) {
-  if (buffer_size < sizeof(IPv4Network) || nullptr == buffer || nullptr == to) {
-    return true;
-  }
-
-  // Check family to determine which structure to use
-  // For IPv4: family is at byte 5 (4 bytes address + 1 byte netmask)
-  // For IPv6: family is at byte 17 (16 bytes address + 1 byte netmask)
-  uint8_t family = buffer[5]; // Try IPv4 first
-
-  if (family == AF_INET_VAL && buffer_size >= sizeof(IPv4Network)) {
-    IPv4Network net;
-    memcpy(&net, buffer, sizeof(IPv4Network));
-
-    char addr_str[32];
-    format_ipv4_address(net.address, addr_str, sizeof(addr_str));
-
-    char result[64];
-    snprintf(result, sizeof(result), "%s/%u", addr_str,
-             (unsigned int)net.netmask);
-
-    size_t len = strlen(result);
-    if (len + 1 > to_size) return true;
-    strcpy(to, result);
-    *to_length = len;
-    return false;
-
-  } else if (buffer_size >= sizeof(IPv6Network)) {
-    // Check if it's IPv6
-    uint8_t ipv6_family = buffer[17]; // Family byte for IPv6
-    if (ipv6_family == AF_INET6_VAL) {
-      IPv6Network net;
-      memcpy(&net, buffer, sizeof(IPv6Network));
-
-      char addr_str[kMaxIPv6String];
-      format_ipv6_address(net.address, addr_str, sizeof(addr_str));
-
-      char result[kMaxIPv6String];
-      snprintf(result, sizeof(result), "%s/%u", addr_str,
-               (unsigned int)net.netmask);
+int cmp_macaddr(CustomArg a, CustomArg b) {
+  auto sa = a.value(), sb = b.value();
+  return network_address::cmp_macaddr(
+      sa.data(), sa.size(),
+      sb.data(), sb.size());
+}
 
-      size_t len = strlen(result);
-      if (len + 1 > to_size) return true;
-      strcpy(to, result);
-      *to_length = len;
-      return false;
-    }
+// --- MACADDR8 ---
+void encode_macaddr8(std::string_view from, CustomResult out) {
+  NETADDR_STAT_SCOPE("MACADDR8.from_string", from);
+  auto buf = out.buffer();
+  size_t length;
+  if (network_address::encode_macaddr8(
+          buf.data(), buf.size(),
+          from.data(), from.size(), &length)) {
+    out.error("invalid MAC address (EUI-64)");
+    return;
   }
-
-  return true; // Unknown family
+  out.set_length(length);
 }
 
-bool encode_inet(unsigned char *buffer, size_t buffer_size, const char *from, size_t from_len, size_t *length) {
-  if (buffer_size < sizeof(IPv4Network) || nullptr == buffer) {
-    return true;
+void decode_macaddr8(CustomArg in, StringResult out) {
+  NETADDR_STAT_SCOPE("macaddr8_to_string", in);
+  if (in.is_null()) {
+    out.set_null();
+    return;
   }
-
-  std::string from_str(from, from_len);
-  char addr_str[64];
-  int netmask = -1; // Will be set based on address family
-
-  // Try parsing with netmask first, then without
-  if (sscanf(from_str.c_str(), "%63[^/]/%d", addr_str, &netmask) != 2) {
-    // No netmask specified, use the whole string as address
-    strncpy(addr_str, from_str.c_str(), sizeof(addr_str) - 1);
-    addr_str[sizeof(addr_str) - 1] = '\0';
+  auto span = in.value();
+  auto buf = out.buffer();
+  size_t length;
+  if (network_address::decode_macaddr8(
+          span.data(), span.size(),
+          buf.data(), buf.size(), &length)) {
+    out.warning("MACADDR8 decode error");
+    return;
   }
+  out.set_length(length);
+}
 
-  // Try IPv4 first
-  IPv4Network net4;
-  if (parse_ipv4_address(addr_str, &net4.address)) {
-    if (netmask == -1) {
-      netmask = IPV4_MAX_PREFIXLEN; // Default for IPv4
-    }
-    if (netmask < 0 || netmask > IPV4_MAX_PREFIXLEN) {
-      return MarkInvalid(length);
-    }
-
-    net4.netmask = static_cast<uint8_t>(netmask);
-    net4.family = AF_INET_VAL;
-    net4.flags = ADDR_FLAG_INET;
+int cmp_macaddr8(CustomArg a, CustomArg b) {
+  auto sa = a.value(), sb = b.value();
+  return network_address::cmp_macaddr8(
+      sa.data(), sa.size(),
+      sb.data(), sb.size());
+}
 
-    memcpy(buffer, &net4, sizeof(IPv4Network));
-    *length = sizeof(IPv4Network);
-    return false;
+// --- INET4 ---
+void encode_inet4(std::string_view from, CustomResult out) {
+  NETADDR_STAT_SCOPE("INET4.from_string", from);
+  auto buf = out.buffer();
+  size_t length;
+  if (network_address::encode_inet4(
+          buf.data(), buf.size(),
+          from.data(), from.size(), &length)) {
+    out.error("invalid INET4 address (IPv4 only)");
+    return;
   }
+  out.set_length(length);
+}
 
-  // Try IPv6
-  if (buffer_size < sizeof(IPv6Network)) {
-    return true;
+void decode_inet4(CustomArg in, StringResult out) {
+  NETADDR_STAT_SCOPE("inet4_to_string", in);
+  if (in.is_null()) {
+    out.set_null();
+    return;
   }
-
-  IPv6Network net6;
-  if (parse_ipv6_address(addr_str, net6.address)) {
-    if (netmask == -1) {
-      netmask = IPV6_MAX_PREFIXLEN; // Default for IPv6
-    }
-    if (netmask < 0 || netmask > IPV6_MAX_PREFIXLEN) {
-      return MarkInvalid(length);
-    }
-
-    net6.netmask = static_cast<uint8_t>(netmask);
-    net6.family = AF_INET6_VAL;
-    net6.flags = ADDR_FLAG_INET;
-
-    memcpy(buffer, &net6, sizeof(IPv6Network));
-    *length = sizeof(IPv6Network);
-    return false;
+  auto span = in.value();
+  auto buf = out.buffer();
+  size_t length;
+  if (network_address::decode_inet4(
+          span.data(), span.size(),
+          buf.data(), buf.size(), &length)) {
+    out.warning("INET4 decode error");
+    return;
   }
-
-  return MarkInvalid(length); // Invalid address format
+  out.set_length(length);
 }
 
-bool decode_inet(const unsigned char *buffer, size_t buffer_size, char *to, size_t to_size, size_t *to_length) {
-  if (buffer_size < sizeof(IPv4Network) || nullptr == buffer || nullptr == to) {
-    return true;
-  }
-
-  // Check family to determine which structure to use
-  uint8_t family = buffer[5]; // Try IPv4 first
-
-  if (family == AF_INET_VAL && buffer_size >= sizeof(IPv4Network)) {
-    IPv4Network net;
-    memcpy(&net, buffer, sizeof(IPv4Network));
-
-    char addr_str[32];
-    format_ipv4_address(net.address, addr_str, sizeof(addr_str));
-
-    char result[64];
-    if (net.netmask == IPV4_MAX_PREFIXLEN) {
-      // Don't show /32 for host addresses
-      snprintf(result, sizeof(result), "%s", addr_str);
-    } else {
-      snprintf(result, sizeof(result), "%s/%u", addr_str,
-               (unsigned int)net.netmask);
-    }
-
-    size_t len = strlen(result);
-    if (len + 1 > to_size) return true;
-    strcpy(to, result);
-    *to_length = len;
-    return false;
-
-  } else if (buffer_size >= sizeof(IPv6Network)) {
-    // Check if it's IPv6
-    uint8_t ipv6_family = buffer[17]; // Family byte for IPv6
-    if (ipv6_family == AF_INET6_VAL) {
-      IPv6Network net;
-      memcpy(&net, buffer, sizeof(IPv6Network));
-
-      char addr_str[kMaxIPv6String];
-      format_ipv6_address(net.address, addr_str, sizeof(addr_str));
-
-      char result[kMaxIPv6String];
-      if (net.netmask == IPV6_MAX_PREFIXLEN) {
-        // Don't show /128 for host addresses
-        snprintf(result, sizeof(result), "%s", addr_str);
-      } else {
-        snprintf(result, sizeof(result), "%s/%u", addr_str,
-                 (unsigned int)net.netmask);
-      }
+int cmp_inet4(CustomArg a, CustomArg b) {
+  auto sa = a.value(), sb = b.value();
+  return network_address::cmp_inet4(
+      sa.data(), sa.size(),
+      sb.data(), sb.size());
+}
 
-      size_t len = strlen(result);
-      if (len + 1 > to_size) return true;
-      strcpy(to, result);
-      *to_length = len;
-      return false;
-    }
+// --- INET6 ---
+void encode_inet6(std::string_view from, CustomResult out) {
+  NETADDR_STAT_SCOPE("INET6.from_string", from);
+  auto buf = out.buffer();
+  size_t length;
+  if (network_address::encode_inet6(
+          buf.data(), buf.size(),
+          from.data(), from.size(), &length)) {
+    out.error("invalid INET6 address (IPv6 only)");
+    return;
   }
-
-  return true; // Unknown family
+  out.set_length(length);
 }
 
-bool encode_macaddr(unsigned char *buffer, size_t buffer_size, const char *from, size_t from_len, size_t *length) {
-  if (buffer_size < sizeof(MacAddr) || nullptr == buffer) {
-    return true;
+void decode_inet6(CustomArg in, StringResult out) {
+  NETADDR_STAT_SCOPE("inet6_to_string", in);
+  if (in.is_null()) {
+    out.set_null();
+    return;
   }
-
-  std::string from_str(from, from_len);
-  MacAddr mac;
-
-  if (!parse_mac_address(from_str.c_str(), mac.address, 6)) {
-    return MarkInvalid(length); // Parse error
+  auto span = in.value();
+  auto buf = out.buffer();
+  size_t length;
+  if (network_address::decode_inet6(
+          span.data(), span.size(),
+          buf.data(), buf.size(), &length)) {
+    out.warning("INET6 decode error");
+    return;
   }
+  out.set_length(length);
+}
 
-  memcpy(buffer, &mac, sizeof(MacAddr));
-  *length = sizeof(MacAddr);
-  return false;
+int cmp_inet6(CustomArg a, CustomArg b) {
+  auto sa = a.value(), sb = b.value();
+  return network_address::cmp_inet6(
+      sa.data(), sa.size(),
+      sb.data(), sb.size());
 }
 
-bool decode_macaddr(const unsigned char *buffer, size_t buffer_size, char *to, size_t to_size, size_t *to_length) {
-  if (buffer_size < sizeof(MacAddr) || nullptr == buffer || nullptr == to) {
-    return true;
-  }
-
-  MacAddr mac;
-  memcpy(&mac, buffer, sizeof(MacAddr));
-
-  char result[kMaxMacAddrString + 1];
-  format_mac_address(mac.address, result, sizeof(result), 6);
-
-  size_t len = strlen(result);
-  if (len + 1 > to_size) return true;
-  strcpy(to, result);
-  *to_length = len;
-  return false;
+// VDF wrappers for the from_string conversions: StringArg → CustomResult.
+// These use .warning() (→ NULL) on invalid input, matching PostgreSQL behavior.
+// The type-level encode_* functions use .error() (hard error) so that
+// INSERT with invalid data fails rather than silently storing NULL.
+// Helper: build "failed to parse string 'X'" message matching V1 format.
+static std::string parse_error_msg(std::string_view input) {
+  std::string msg = "failed to parse string '";
+  msg.append(input.data(), input.size());
+  msg += "'";
+  return msg;
 }
 
-bool encode_macaddr8(unsigned char *buffer, size_t buffer_size, const char *from, size_t from_len, size_t *length) {
-  if (buffer_size < sizeof(MacAddr8) || nullptr == buffer) {
-    return true;
+void cidr_from_string_vdf(StringArg s, CustomResult out) {
+  NETADDR_STAT_SCOPE("cidr_from_string", s);
+  if (s.is_null()) {
+    out.set_null();
+    return;
   }
-
-  std::string from_str(from, from_len);
-  MacAddr8 mac8;
-
-  if (!parse_mac_address(from_str.c_str(), mac8.address, 8)) {
-    return MarkInvalid(length); // Parse error
+  auto sv = s.value();
+  auto buf = out.buffer();
+  size_t length;
+  if (network_address::encode_cidr(
+          buf.data(), buf.size(), sv.data(),
+          sv.size(), &length)) {
+    out.warning(parse_error_msg(sv));
+    return;
   }
-
-  memcpy(buffer, &mac8, sizeof(MacAddr8));
-  *length = sizeof(MacAddr8);
-  return false;
+  out.set_length(length);
 }
 
-bool decode_macaddr8(const unsigned char *buffer, size_t buffer_size, char *to, size_t to_size, size_t *to_length) {
-  if (buffer_size < sizeof(MacAddr8) || nullptr == buffer || nullptr == to) {
-    return true;
+void inet_from_string_vdf(StringArg s, CustomResult out) {
+  NETADDR_STAT_SCOPE("inet_from_string", s);
+  if (s.is_null()) {
+    out.set_null();
+    return;
   }
-
-  MacAddr8 mac8;
-  memcpy(&mac8, buffer, sizeof(MacAddr8));
-
-  char result[kMaxMacAddr8String + 1];
-  format_mac_address(mac8.address, result, sizeof(result), 8);
-
-  size_t len = strlen(result);
-  if (len + 1 > to_size) return true;
-  strcpy(to, result);
-  *to_length = len;
-  return false;
+  auto sv = s.value();
+  auto buf = out.buffer();
+  size_t length;
+  if (network_address::encode_inet(
+          buf.data(), buf.size(), sv.data(),
+          sv.size(), &length)) {
+    out.warning(parse_error_msg(sv));
+    return;
+  }
+  out.set_length(length);
 }
 
-// Comparison functions for each type
-
-int cmp_cidr(const unsigned char *data1, size_t len1, const unsigned char *data2, size_t len2) {
-  // Both CIDR values should be the same size (IPv4Network or IPv6Network)
-  if (len1 != len2) {
-    // Different sizes mean different address families
-    // IPv4 (7 bytes) sorts before IPv6 (19 bytes) per PostgreSQL spec
-    return (len1 < len2) ? -1 : 1;
+void macaddr_from_string_vdf(StringArg s, CustomResult out) {
+  NETADDR_STAT_SCOPE("macaddr_from_string", s);
+  if (s.is_null()) {
+    out.set_null();
+    return;
   }
+  auto sv = s.value();
+  auto buf = out.buffer();
+  size_t length;
+  if (network_address::encode_macaddr(
+          buf.data(), buf.size(), sv.data(),
+          sv.size(), &length)) {
+    out.warning(parse_error_msg(sv));
+    return;
+  }
+  out.set_length(length);
+}
 
-  if (len1 == sizeof(IPv4Network)) {
-    // Compare IPv4 networks
-    IPv4Network net1, net2;
-    memcpy(&net1, data1, sizeof(IPv4Network));
-    memcpy(&net2, data2, sizeof(IPv4Network));
-
-    // Compare network address first
-    if (net1.address != net2.address) {
-      return (net1.address < net2.address) ? -1 : 1;
-    }
-
-    // If network addresses are equal, compare netmask
-    if (net1.netmask != net2.netmask) {
-      return (net1.netmask < net2.netmask) ? -1 : 1;
-    }
-
-    return 0; // Equal
-  } else if (len1 == sizeof(IPv6Network)) {
-    // Compare IPv6 networks
-    IPv6Network net1, net2;
-    memcpy(&net1, data1, sizeof(IPv6Network));
-    memcpy(&net2, data2, sizeof(IPv6Network));
-
-    // Compare IPv6 addresses byte by byte
-    int addr_cmp = memcmp(net1.address, net2.address, 16);
-    if (addr_cmp != 0) {
-      return (addr_cmp < 0) ? -1 : 1;
-    }
-
-    // If network addresses are equal, compare netmask
-    if (net1.netmask != net2.netmask) {
-      return (net1.netmask < net2.netmask) ? -1 : 1;
-    }
-
-    return 0; // Equal
+void macaddr8_from_string_vdf(StringArg s, CustomResult out) {
+  NETADDR_STAT_SCOPE("macaddr8_from_string", s);
+  if (s.is_null()) {
+    out.set_null();
+    return;
   }
+  auto sv = s.value();
+  auto buf = out.buffer();
+  size_t length;
+  if (network_address::encode_macaddr8(
+          buf.data(), buf.size(), sv.data(),
+          sv.size(), &length)) {
+    out.warning(parse_error_msg(sv));
+    return;
+  }
+  out.set_length(length);
+}
 
-  // Fallback to binary comparison
-  int result = memcmp(data1, data2, len1);
-  if (result == 0) return 0;
-  return (result < 0) ? -1 : 1;
+void inet4_from_string_vdf(StringArg s, CustomResult out) {
+  NETADDR_STAT_SCOPE("inet4_from_string", s);
+  if (s.is_null()) {
+    out.set_null();
+    return;
+  }
+  auto sv = s.value();
+  auto buf = out.buffer();
+  size_t length;
+  if (network_address::encode_inet4(
+          buf.data(), buf.size(), sv.data(),
+          sv.size(), &length)) {
+    out.warning(parse_error_msg(sv));
+    return;
+  }
+  out.set_length(length);
 }
 
-int cmp_inet(const unsigned char *data1, size_t len1, const unsigned char *data2, size_t len2) {
-  // INET comparison is the same as CIDR comparison
-  // Both use the same internal structure and comparison logic
-  return cmp_cidr(data1, len1, data2, len2);
+void inet6_from_string_vdf(StringArg s, CustomResult out) {
+  NETADDR_STAT_SCOPE("inet6_from_string", s);
+  if (s.is_null()) {
+    out.set_null();
+    return;
+  }
+  auto sv = s.value();
+  auto buf = out.buffer();
+  size_t length;
+  if (network_address::encode_inet6(
+          buf.data(), buf.size(), sv.data(),
+          sv.size(), &length)) {
+    out.warning(parse_error_msg(sv));
+    return;
+  }
+  out.set_length(length);
 }
 
-int cmp_macaddr(const unsigned char *data1, size_t len1, const unsigned char *data2, size_t len2) {
-  (void)len1;  // Used in assert, suppress warning
-  (void)len2;  // Used in assert, suppress warning
-  assert(sizeof(MacAddr) == len1);
-  assert(len1 == len2);
+// Silent variants for ETL filtering: *_is_valid returns 1/0 and
+// try_*_from_string returns NULL on bad input, neither raising a warning.
+// Both go through the same allocation-free encoders as the type itself.
+using EncodeFn = bool (*)(unsigned char *, size_t, const char *, size_t,
+                          size_t *);
 
-  MacAddr mac1, mac2;
-  memcpy(&mac1, data1, sizeof(MacAddr));
-  memcpy(&mac2, data2, sizeof(MacAddr));
+static void string_is_valid(EncodeFn encode, StringArg s, IntResult out) {
+  if (s.is_null()) {
+    out.set_null();
+    return;
+  }
+  auto sv = s.value();
+  unsigned char scratch[sizeof(network_address::IPv6Network)];
+  size_t length;
+  out.set(encode(scratch, sizeof(scratch), sv.data(), sv.size(), &length)
+              ? 0
+              : 1);
+}
 
-  // Binary comparison of MAC addresses
-  int result = memcmp(mac1.address, mac2.address, 6);
-  if (result == 0) return 0;
-  return (result < 0) ? -1 : 1;
+static void try_from_string(EncodeFn encode, StringArg s, CustomResult out) {
+  if (s.is_null()) {
+    out.set_null();
+    return;
+  }
+  auto sv = s.value();
+  auto buf = out.buffer();
+  size_t length;
+  if (encode(buf.data(), buf.size(), sv.data(), sv.size(), &length)) {
+    out.set_null();
+    return;
+  }
+  out.set_length(length);
 }
 
-int cmp_macaddr8(const unsigned char *data1, size_t len1, const unsigned char *data2, size_t len2) {
-  (void)len1;  // Used in assert, suppress warning
-  (void)len2;  // Used in assert, suppress warning
-  assert(sizeof(MacAddr8) == len1);
-  assert(len1 == len2);
+void cidr_is_valid_impl(StringArg s, IntResult out) {
+  NETADDR_STAT_SCOPE("cidr_is_valid", s);
+  string_is_valid(&network_address::encode_cidr, s, out);
+}
 
-  MacAddr8 mac1, mac2;
-  memcpy(&mac1, data1, sizeof(MacAddr8));
-  memcpy(&mac2, data2, sizeof(MacAddr8));
+void inet_is_valid_impl(StringArg s, IntResult out) {
+  NETADDR_STAT_SCOPE("inet_is_valid", s);
+  string_is_valid(&network_address::encode_inet, s, out);
+}
 
-  // Binary comparison of MAC addresses
-  int result = memcmp(mac1.address, mac2.address, 8);
-  if (result == 0) return 0;
-  return (result < 0) ? -1 : 1;
+void macaddr_is_valid_impl(StringArg s, IntResult out) {
+  NETADDR_STAT_SCOPE("macaddr_is_valid", s);
+  string_is_valid(&network_address::encode_macaddr, s, out);
 }
 
-// ============================================================================
-// Helper functions for mask calculations
-// ============================================================================
+void macaddr8_is_valid_impl(StringArg s, IntResult out) {
+  NETADDR_STAT_SCOPE("macaddr8_is_valid", s);
+  string_is_valid(&network_address::encode_macaddr8, s, out);
+}
 
-// Calculate IPv4 netmask from prefix length
-uint32_t prefix_to_netmask_ipv4(uint8_t prefix_len) {
-  if (prefix_len == 0) {
-    return 0;
-  }
-  if (prefix_len >= 32) {
-    return 0xFFFFFFFF;
-  }
-  return ~((1u << (32 - prefix_len)) - 1);
+void try_cidr_from_string_impl(StringArg s, CustomResult out) {
+  NETADDR_STAT_SCOPE("try_cidr_from_string", s);
+  try_from_string(&network_address::encode_cidr, s, out);
 }
 
-// Calculate IPv4 hostmask from prefix length (inverse of netmask)
-uint32_t prefix_to_hostmask_ipv4(uint8_t prefix_len) {
-  if (prefix_len >= 32) {
-    return 0;
-  }
-  return (1u << (32 - prefix_len)) - 1;
+void try_inet_from_string_impl(StringArg s, CustomResult out) {
+  NETADDR_STAT_SCOPE("try_inet_from_string", s);
+  try_from_string(&network_address::encode_inet, s, out);
 }
 
-// Calculate IPv6 netmask from prefix length
-void prefix_to_netmask_ipv6(uint8_t prefix_len, uint8_t *netmask) {
-  memset(netmask, 0, 16);
+void try_macaddr_from_string_impl(StringArg s, CustomResult out) {
+  NETADDR_STAT_SCOPE("try_macaddr_from_string", s);
+  try_from_string(&network_address::encode_macaddr, s, out);
+}
 
-  int full_bytes = prefix_len / 8;
-  int remaining_bits = prefix_len % 8;
+void try_macaddr8_from_string_impl(StringArg s, CustomResult out) {
+  NETADDR_STAT_SCOPE("try_macaddr8_from_string", s);
+  try_from_string(&network_address::encode_macaddr8, s, out);
+}
 
-  // Set full bytes to 0xFF
-  for (int i = 0; i < full_bytes && i < 16; i++) {
-    netmask[i] = 0xFF;
-  }
+// =============================================================================
+// VDF Wrapper Functions
+// =============================================================================
 
-  // Set partial byte if exists
-  if (full_bytes < 16 && remaining_bits > 0) {
-    netmask[full_bytes] = 0xFF << (8 - remaining_bits);
-  }
+// Helper: get raw const unsigned char* from CustomArg span
+static inline const unsigned char *span_data(CustomArg arg) {
+  return arg.value().data();
 }
 
-// Calculate IPv6 hostmask from prefix length (inverse of netmask)
-void prefix_to_hostmask_ipv6(uint8_t prefix_len, uint8_t *hostmask) {
-  memset(hostmask, 0, 16);
+static inline size_t span_size(CustomArg arg) { return arg.value().size(); }
 
-  int full_bytes = prefix_len / 8;
-  int remaining_bits = prefix_len % 8;
+void cidr_compare_impl(CustomArg a, CustomArg b, IntResult out) {
+  NETADDR_STAT_SCOPE("cidr_compare", a, b);
+  if (a.is_null() || b.is_null()) { out.set_null(); return; }
+  out.set(network_address::cmp_cidr(span_data(a), span_size(a),
+                                    span_data(b), span_size(b)));
+}
 
-  // Set partial byte if exists
-  if (full_bytes < 16 && remaining_bits > 0) {
-    hostmask[full_bytes] = ~(0xFF << (8 - remaining_bits));
-    full_bytes++;
-  }
+void inet_compare_impl(CustomArg a, CustomArg b, IntResult out) {
+  NETADDR_STAT_SCOPE("inet_compare", a, b);
+  if (a.is_null() || b.is_null()) { out.set_null(); return; }
+  out.set(network_address::cmp_inet(span_data(a), span_size(a),
+                                    span_data(b), span_size(b)));
+}
 
-  // Set remaining bytes to 0xFF
-  for (int i = full_bytes; i < 16; i++) {
-    hostmask[i] = 0xFF;
-  }
+void macaddr_compare_impl(CustomArg a, CustomArg b, IntResult out) {
+  NETADDR_STAT_SCOPE("macaddr_compare", a, b);
+  if (a.is_null() || b.is_null()) { out.set_null(); return; }
+  out.set(network_address::cmp_macaddr(span_data(a), span_size(a),
+                                       span_data(b), span_size(b)));
 }
 
-// ============================================================================
-// Simple Extractors
-// ============================================================================
+void macaddr8_compare_impl(CustomArg a, CustomArg b, IntResult out) {
+  NETADDR_STAT_SCOPE("macaddr8_compare", a, b);
+  if (a.is_null() || b.is_null()) { out.set_null(); return; }
+  out.set(network_address::cmp_macaddr8(span_data(a), span_size(a),
+                                        span_data(b), span_size(b)));
+}
 
-// Helper to get family from buffer
-static inline uint8_t get_address_family(const unsigned char *buffer,
-                                         size_t buffer_size) {
-  if (buffer == nullptr || buffer_size < sizeof(IPv4Network)) {
-    return 0;
+void inet_family_impl(CustomArg arg, IntResult out) {
+  NETADDR_STAT_SCOPE("inet_family", arg);
+  if (arg.is_null()) {
+    out.set_null();
+    return;
   }
-
-  // Try IPv4 first (family at offset 5)
-  uint8_t family = buffer[5];
-  if (family == AF_INET_VAL) {
-    return AF_INET_VAL;
+  int family = network_address::inet_family(span_data(arg), span_size(arg));
+  if (family < 0) {
+    out.set_null();
+    return;
   }
+  out.set(family);
+}
 
-  // Try IPv6 (family at offset 17)
-  if (buffer_size >= sizeof(IPv6Network)) {
-    family = buffer[17];
-    if (family == AF_INET6_VAL) {
-      return AF_INET6_VAL;
-    }
+void inet_masklen_impl(CustomArg arg, IntResult out) {
+  NETADDR_STAT_SCOPE("inet_masklen", arg);
+  if (arg.is_null()) {
+    out.set_null();
+    return;
   }
-
-  return 0; // Unknown
+  int masklen = network_address::inet_masklen(span_data(arg), span_size(arg));
+  if (masklen < 0) {
+    out.set_null();
+    return;
+  }
+  out.set(masklen);
 }
 
-// family(inet) → int
-// Extract family of address; 4 for IPv4, 6 for IPv6
-int inet_family(const unsigned char *buffer, size_t buffer_size) {
-  uint8_t family = get_address_family(buffer, buffer_size);
-
-  if (family == AF_INET_VAL) {
-    return 4;  // IPv4
-  } else if (family == AF_INET6_VAL) {
-    return 6;  // IPv6
+void inet_host_impl(CustomArg arg, StringResult out) {
+  NETADDR_STAT_SCOPE("inet_host", arg);
+  if (arg.is_null()) {
+    out.set_null();
+    return;
   }
-
-  return -1;  // Unknown family
+  auto buf = out.buffer();
+  size_t str_len;
+  if (network_address::inet_host(span_data(arg), span_size(arg), buf.data(),
+                                 buf.size(), &str_len)) {
+    out.warning("inet_host: error");
+    return;
+  }
+  out.set_length(str_len);
 }
 
-// masklen(inet) → int
-// Extract netmask length
-int inet_masklen(const unsigned char *buffer, size_t buffer_size) {
-  if (buffer == nullptr || buffer_size < sizeof(IPv4Network)) {
-    return -1;  // Error
+void inet_text_impl(CustomArg arg, StringResult out) {
+  NETADDR_STAT_SCOPE("inet_text", arg);
+  if (arg.is_null()) {
+    out.set_null();
+    return;
   }
-
-  uint8_t family = get_address_family(buffer, buffer_size);
-
-  if (family == AF_INET_VAL) {
-    return buffer[4]; // Netmask at offset 4 for IPv4
-  } else if (family == AF_INET6_VAL) {
-    return buffer[16]; // Netmask at offset 16 for IPv6
+  auto buf = out.buffer();
+  size_t str_len;
+  if (network_address::inet_text(span_data(arg), span_size(arg), buf.data(),
+                                 buf.size(), &str_len)) {
+    out.warning("inet_text: error");
+    return;
   }
-
-  return -1;  // Error
+  out.set_length(str_len);
 }
 
-// host(inet) → text
-// Extract IP address as text (without netmask)
-bool inet_host(const unsigned char *buffer, size_t buffer_size, char *result, size_t result_size, size_t *result_length) {
-  if (buffer == nullptr || buffer_size < sizeof(IPv4Network) || result == nullptr) {
-    return true;  // Error
+void inet_netmask_impl(CustomArg arg, CustomResult out) {
+  NETADDR_STAT_SCOPE("inet_netmask", arg);
+  if (arg.is_null()) {
+    out.set_null();
+    return;
   }
-
-  uint8_t family = get_address_family(buffer, buffer_size);
-
-  if (family == AF_INET_VAL) {
-    IPv4Network net;
-    memcpy(&net, buffer, sizeof(IPv4Network));
-
-    char addr_str[kMaxIPv4String];
-    format_ipv4_address(net.address, addr_str, sizeof(addr_str));
-
-    size_t len = strlen(addr_str);
-    if (len + 1 > result_size) return true;
-    strcpy(result, addr_str);
-    *result_length = len;
-    return false;  // Success
-
-  } else if (family == AF_INET6_VAL && buffer_size >= sizeof(IPv6Network)) {
-    IPv6Network net;
-    memcpy(&net, buffer, sizeof(IPv6Network));
-
-    char addr_str[kMaxIPv6String];
-    format_ipv6_address(net.address, addr_str, sizeof(addr_str));
-
-    size_t len = strlen(addr_str);
-    if (len + 1 > result_size) return true;
-    strcpy(result, addr_str);
-    *result_length = len;
-    return false;  // Success
+  auto buf = out.buffer();
+  size_t bin_len;
+  if (network_address::inet_netmask(
+          span_data(arg), span_size(arg),
+          buf.data(), &bin_len)) {
+    out.warning("inet_netmask: error");
+    return;
   }
-
-  return true;  // Error: unknown family
+  out.set_length(bin_len);
 }
 
-// text(inet) → text
-// Extract IP address and netmask length as text (always include prefix)
-bool inet_text(const unsigned char *buffer, size_t buffer_size, char *result, size_t result_size, size_t *result_length) {
-  if (buffer == nullptr || buffer_size < sizeof(IPv4Network) || result == nullptr) {
-    return true;  // Error
+void inet_hostmask_impl(CustomArg arg, CustomResult out) {
+  NETADDR_STAT_SCOPE("inet_hostmask", arg);
+  if (arg.is_null()) {
+    out.set_null();
+    return;
   }
-
-  uint8_t family = get_address_family(buffer, buffer_size);
-
-  if (family == AF_INET_VAL) {
-    IPv4Network net;
-    memcpy(&net, buffer, sizeof(IPv4Network));
-
-    char addr_str[kMaxIPv4String];
-    format_ipv4_address(net.address, addr_str, sizeof(addr_str));
-
-    char result_str[kMaxIPv4String];
-    snprintf(result_str, sizeof(result_str), "%s/%u", addr_str, net.netmask);
-
-    size_t len = strlen(result_str);
-    if (len + 1 > result_size) return true;
-    strcpy(result, result_str);
-    *result_length = len;
-    return false;  // Success
-
-  } else if (family == AF_INET6_VAL && buffer_size >= sizeof(IPv6Network)) {
-    IPv6Network net;
-    memcpy(&net, buffer, sizeof(IPv6Network));
-
-    char addr_str[kMaxIPv6String];
-    format_ipv6_address(net.address, addr_str, sizeof(addr_str));
-
-    char result_str[kMaxIPv6String];
-    snprintf(result_str, sizeof(result_str), "%s/%u", addr_str, net.netmask);
-
-    size_t len = strlen(result_str);
-    if (len + 1 > result_size) return true;
-    strcpy(result, result_str);
-    *result_length = len;
-    return false;  // Success
+  auto buf = out.buffer();
+  size_t bin_len;
+  if (network_address::inet_hostmask(
+          span_data(arg), span_size(arg),
+          buf.data(), &bin_len)) {
+    out.warning("inet_hostmask: error");
+    return;
   }
-
-  return true;  // Error: unknown family
+  out.set_length(bin_len);
 }
 
-// ============================================================================
-// Mask Calculations
-// ============================================================================
-
-// netmask(inet) → inet
-// Construct netmask for network
-bool inet_netmask(const unsigned char *buffer, size_t buffer_size,
-                  unsigned char *result_buffer, size_t *result_length) {
-  if (buffer == nullptr || buffer_size < sizeof(IPv4Network) ||
-      result_buffer == nullptr || result_length == nullptr) {
-    return true;  // Error
+void inet_broadcast_impl(CustomArg arg, CustomResult out) {
+  NETADDR_STAT_SCOPE("inet_broadcast", arg);
+  if (arg.is_null()) {
+    out.set_null();
+    return;
   }
-
-  uint8_t family = get_address_family(buffer, buffer_size);
-
-  if (family == AF_INET_VAL && buffer_size >= sizeof(IPv4Network)) {
-    IPv4Network net;
-    memcpy(&net, buffer, sizeof(IPv4Network));
-
-    // Create netmask from prefix length
-    uint32_t netmask_addr = prefix_to_netmask_ipv4(net.netmask);
-
-    // Create result as INET with the netmask address and /32
-    IPv4Network result;
-    result.address = netmask_addr;
-    result.netmask = 32;  // Netmask is always shown as /32
-    result.family = AF_INET_VAL;
-    result.flags = ADDR_FLAG_INET;
-
-    memcpy(result_buffer, &result, sizeof(IPv4Network));
-    *result_length = sizeof(IPv4Network);
-    return false;  // Success
-
-  } else if (family == AF_INET6_VAL && buffer_size >= sizeof(IPv6Network)) {
-    IPv6Network net;
-    memcpy(&net, buffer, sizeof(IPv6Network));
-
-    // Create netmask from prefix length
-    IPv6Network result;
-    prefix_to_netmask_ipv6(net.netmask, result.address);
-    result.netmask = 128; // Netmask is always shown as /128
-    result.family = AF_INET6_VAL;
-    result.flags = ADDR_FLAG_INET;
-
-    memcpy(result_buffer, &result, sizeof(IPv6Network));
-    *result_length = sizeof(IPv6Network);
-    return false; // Success
+  auto buf = out.buffer();
+  size_t bin_len;
+  if (network_address::inet_broadcast(
+          span_data(arg), span_size(arg),
+          buf.data(), &bin_len)) {
+    out.warning("inet_broadcast: error");
+    return;
   }
-
-  return true;  // Error: unsupported family
+  out.set_length(bin_len);
 }
 
-// hostmask(inet) → inet
-// Construct host mask for network (inverse of netmask)
-bool inet_hostmask(const unsigned char *buffer, size_t buffer_size,
-                   unsigned char *result_buffer, size_t *result_length) {
-  if (buffer == nullptr || buffer_size < sizeof(IPv4Network) ||
-      result_buffer == nullptr || result_length == nullptr) {
-    return true;  // Error
+void inet_network_impl(CustomArg arg, CustomResult out) {
+  NETADDR_STAT_SCOPE("inet_network", arg);
+  if (arg.is_null()) {
+    out.set_null();
+    return;
   }
-
-  uint8_t family = get_address_family(buffer, buffer_size);
-
-  if (family == AF_INET_VAL && buffer_size >= sizeof(IPv4Network)) {
-    IPv4Network net;
-    memcpy(&net, buffer, sizeof(IPv4Network));
-
-    // Create hostmask from prefix length
-    uint32_t hostmask_addr = prefix_to_hostmask_ipv4(net.netmask);
-
-    // Create result as INET with the hostmask address and /32
-    IPv4Network result;
-    result.address = hostmask_addr;
-    result.netmask = 32;  // Hostmask is always shown as /32
-    result.family = AF_INET_VAL;
-    result.flags = ADDR_FLAG_INET;
-
-    memcpy(result_buffer, &result, sizeof(IPv4Network));
-    *result_length = sizeof(IPv4Network);
-    return false;  // Success
-
-  } else if (family == AF_INET6_VAL && buffer_size >= sizeof(IPv6Network)) {
-    IPv6Network net;
-    memcpy(&net, buffer, sizeof(IPv6Network));
-
-    // Create hostmask from prefix length
-    IPv6Network result;
-    prefix_to_hostmask_ipv6(net.netmask, result.address);
-    result.netmask = 128; // Hostmask is always shown as /128
-    result.family = AF_INET6_VAL;
-    result.flags = ADDR_FLAG_INET;
-
-    memcpy(result_buffer, &result, sizeof(IPv6Network));
-    *result_length = sizeof(IPv6Network);
-    return false; // Success
+  auto buf = out.buffer();
+  size_t bin_len;
+  if (network_address::inet_network(
+          span_data(arg), span_size(arg),
+          buf.data(), &bin_len)) {
+    out.warning("inet_network: error");
+    return;
   }
-
-  return true;  // Error: unsupported family
+  out.set_length(bin_len);
 }
 
-// broadcast(inet) → inet
-// Calculate broadcast address for network
-bool inet_broadcast(const unsigned char *buffer, size_t buffer_size,
-                    unsigned char *result_buffer, size_t *result_length) {
-  if (buffer == nullptr || buffer_size < sizeof(IPv4Network) ||
-      result_buffer == nullptr || result_length == nullptr) {
-    return true;  // Error
+void inet_set_masklen_impl(CustomArg inet_arg, IntArg len_arg,
+                           CustomResult out) {
+  NETADDR_STAT_SCOPE("inet_set_masklen", inet_arg, len_arg);
+  if (inet_arg.is_null() || len_arg.is_null()) {
+    out.set_null();
+    return;
   }
-
-  uint8_t family = get_address_family(buffer, buffer_size);
-
-  if (family == AF_INET_VAL && buffer_size >= sizeof(IPv4Network)) {
-    IPv4Network net;
-    memcpy(&net, buffer, sizeof(IPv4Network));
-
-    // Calculate broadcast: address OR hostmask
-    uint32_t hostmask = prefix_to_hostmask_ipv4(net.netmask);
-    uint32_t broadcast_addr = net.address | hostmask;
-
-    // Create result as INET with the broadcast address and same netmask
-    IPv4Network result;
-    result.address = broadcast_addr;
-    result.netmask = net.netmask;
-    result.family = AF_INET_VAL;
-    result.flags = ADDR_FLAG_INET;
-
-    memcpy(result_buffer, &result, sizeof(IPv4Network));
-    *result_length = sizeof(IPv4Network);
-    return false;  // Success
-
-  } else if (family == AF_INET6_VAL && buffer_size >= sizeof(IPv6Network)) {
-    IPv6Network net;
-    memcpy(&net, buffer, sizeof(IPv6Network));
-
-    // Calculate broadcast: address OR hostmask
-    IPv6Network result;
-    uint8_t hostmask[16];
-    prefix_to_hostmask_ipv6(net.netmask, hostmask);
-
-    for (int i = 0; i < 16; i++) {
-      result.address[i] = net.address[i] | hostmask[i];
-    }
-    result.netmask = net.netmask;
-    result.family = AF_INET6_VAL;
-    result.flags = ADDR_FLAG_INET;
-
-    memcpy(result_buffer, &result, sizeof(IPv6Network));
-    *result_length = sizeof(IPv6Network);
-    return false; // Success
+  auto buf = out.buffer();
+  size_t bin_len;
+  if (network_address::inet_set_masklen(
+          span_data(inet_arg), span_size(inet_arg), (int)len_arg.value(),
+          buf.data(), &bin_len)) {
+    out.warning("inet_set_masklen: error");
+    return;
   }
-
-  return true;  // Error: unsupported family
+  out.set_length(bin_len);
 }
 
-// network(inet) → cidr
-// Extract network part of address (zero out host bits)
-bool inet_network(const unsigned char *buffer, size_t buffer_size,
-                  unsigned char *result_buffer, size_t *result_length) {
-  if (buffer == nullptr || buffer_size < sizeof(IPv4Network) ||
-      result_buffer == nullptr || result_length == nullptr) {
-    return true;  // Error
+void cidr_set_masklen_impl(CustomArg cidr_arg, IntArg len_arg,
+                           CustomResult out) {
+  NETADDR_STAT_SCOPE("cidr_set_masklen", cidr_arg, len_arg);
+  if (cidr_arg.is_null() || len_arg.is_null()) {
+    out.set_null();
+    return;
   }
-
-  uint8_t family = get_address_family(buffer, buffer_size);
-
-  if (family == AF_INET_VAL && buffer_size >= sizeof(IPv4Network)) {
-    IPv4Network net;
-    memcpy(&net, buffer, sizeof(IPv4Network));
-
-    // Calculate network: address AND netmask
-    uint32_t netmask = prefix_to_netmask_ipv4(net.netmask);
-    uint32_t network_addr = net.address & netmask;
-
-    // Create result as CIDR (strict network address)
-    IPv4Network result;
-    result.address = network_addr;
-    result.netmask = net.netmask;
-    result.family = AF_INET_VAL;
-    result.flags = ADDR_FLAG_CIDR;
-
-    memcpy(result_buffer, &result, sizeof(IPv4Network));
-    *result_length = sizeof(IPv4Network);
-    return false;  // Success
-
-  } else if (family == AF_INET6_VAL && buffer_size >= sizeof(IPv6Network)) {
-    IPv6Network net;
-    memcpy(&net, buffer, sizeof(IPv6Network));
-
-    // Calculate network: address AND netmask
-    IPv6Network result;
-    uint8_t netmask[16];
-    prefix_to_netmask_ipv6(net.netmask, netmask);
-
-    for (int i = 0; i < 16; i++) {
-      result.address[i] = net.address[i] & netmask[i];
-    }
-    result.netmask = net.netmask;
-    result.family = AF_INET6_VAL;
-    result.flags = ADDR_FLAG_CIDR;
-
-    memcpy(result_buffer, &result, sizeof(IPv6Network));
-    *result_length = sizeof(IPv6Network);
-    return false; // Success
+  auto buf = out.buffer();
+  size_t bin_len;
+  if (network_address::cidr_set_masklen(
+          span_data(cidr_arg), span_size(cidr_arg), (int)len_arg.value(),
+          buf.data(), &bin_len)) {
+    out.warning("cidr_set_masklen: error");
+    return;
   }
-
-  return true;  // Error: unsupported family
+  out.set_length(bin_len);
 }
 
-// ============================================================================
-// Modifiers
-// ============================================================================
-
-// set_masklen(inet, int) → inet
-// Set netmask length for inet value (does not modify address bits)
-bool inet_set_masklen(const unsigned char *buffer, size_t buffer_size,
-                      int new_masklen, unsigned char *result_buffer, size_t *result_length) {
-  if (buffer == nullptr || buffer_size < sizeof(IPv4Network) ||
-      result_buffer == nullptr || result_length == nullptr) {
-    return true;  // Error
-  }
-
-  uint8_t family = get_address_family(buffer, buffer_size);
-
-  if (family == AF_INET_VAL && buffer_size >= sizeof(IPv4Network)) {
-    // Validate new masklen for IPv4
-    if (new_masklen < 0 || new_masklen > 32) {
-      return true;  // Invalid masklen
-    }
-
-    IPv4Network net;
-    memcpy(&net, buffer, sizeof(IPv4Network));
-
-    // Create result with same address but new netmask
-    IPv4Network result;
-    result.address = net.address;
-    result.netmask = new_masklen;
-    result.family = AF_INET_VAL;
-    result.flags = ADDR_FLAG_INET;
-
-    memcpy(result_buffer, &result, sizeof(IPv4Network));
-    *result_length = sizeof(IPv4Network);
-    return false;  // Success
-
-  } else if (family == AF_INET6_VAL && buffer_size >= sizeof(IPv6Network)) {
-    // Validate new masklen for IPv6
-    if (new_masklen < 0 || new_masklen > 128) {
-      return true; // Invalid masklen
-    }
-
-    IPv6Network net;
-    memcpy(&net, buffer, sizeof(IPv6Network));
-
-    // Create result with same address but new netmask
-    IPv6Network result;
-    memcpy(result.address, net.address, 16);
-    result.netmask = new_masklen;
-    result.family = AF_INET6_VAL;
-    result.flags = ADDR_FLAG_INET;
-
-    memcpy(result_buffer, &result, sizeof(IPv6Network));
-    *result_length = sizeof(IPv6Network);
-    return false; // Success
+void macaddr_trunc_impl(CustomArg arg, CustomResult out) {
+  NETADDR_STAT_SCOPE("macaddr_trunc", arg);
+  if (arg.is_null()) {
+    out.set_null();
+    return;
   }
-
-  return true;  // Error: unsupported family
+  auto buf = out.buffer();
+  size_t bin_len;
+  if (network_address::macaddr_trunc(
+          span_data(arg), span_size(arg),
+          buf.data(), &bin_len)) {
+    out.warning("macaddr_trunc: error");
+    return;
+  }
+  out.set_length(bin_len);
 }
 
-// set_masklen(cidr, int) → cidr
-// Set netmask length for cidr value (zeros out host bits)
-bool cidr_set_masklen(const unsigned char *buffer, size_t buffer_size,
-                      int new_masklen, unsigned char *result_buffer, size_t *result_length) {
-  if (buffer == nullptr || buffer_size < sizeof(IPv4Network) ||
-      result_buffer == nullptr || result_length == nullptr) {
-    return true;  // Error
+void macaddr_to_bigint_impl(CustomArg arg, IntResult out) {
+  NETADDR_STAT_SCOPE("macaddr_to_bigint", arg);
+  if (arg.is_null()) {
+    out.set_null();
+    return;
   }
-
-  uint8_t family = get_address_family(buffer, buffer_size);
-
-  if (family == AF_INET_VAL && buffer_size >= sizeof(IPv4Network)) {
-    // Validate new masklen for IPv4
-    if (new_masklen < 0 || new_masklen > 32) {
-      return true;  // Invalid masklen
-    }
-
-    IPv4Network net;
-    memcpy(&net, buffer, sizeof(IPv4Network));
-
-    // Calculate network address by zeroing host bits
-    uint32_t netmask = prefix_to_netmask_ipv4(new_masklen);
-    uint32_t network_addr = net.address & netmask;
-
-    // Create result with network address and new netmask
-    IPv4Network result;
-    result.address = network_addr;
-    result.netmask = new_masklen;
-    result.family = AF_INET_VAL;
-    result.flags = ADDR_FLAG_CIDR;
-
-    memcpy(result_buffer, &result, sizeof(IPv4Network));
-    *result_length = sizeof(IPv4Network);
-    return false;  // Success
-
-  } else if (family == AF_INET6_VAL && buffer_size >= sizeof(IPv6Network)) {
-    // Validate new masklen for IPv6
-    if (new_masklen < 0 || new_masklen > 128) {
-      return true; // Invalid masklen
-    }
-
-    IPv6Network net;
-    memcpy(&net, buffer, sizeof(IPv6Network));
-
-    // Calculate network address by zeroing host bits
-    IPv6Network result;
-    uint8_t netmask[16];
-    prefix_to_netmask_ipv6(new_masklen, netmask);
-
-    for (int i = 0; i < 16; i++) {
-      result.address[i] = net.address[i] & netmask[i];
-    }
-    result.netmask = new_masklen;
-    result.family = AF_INET6_VAL;
-    result.flags = ADDR_FLAG_CIDR;
-
-    memcpy(result_buffer, &result, sizeof(IPv6Network));
-    *result_length = sizeof(IPv6Network);
-    return false; // Success
-  }
-
-  return true;  // Error: unsupported family
-}
-
-// trunc(macaddr) → macaddr
-// Set last 3 bytes to zero (keep manufacturer OUI)
-bool macaddr_trunc(const unsigned char *buffer, size_t buffer_size,
-                   unsigned char *result_buffer, size_t *result_length) {
-  if (buffer == nullptr || buffer_size < sizeof(MacAddr) ||
-      result_buffer == nullptr || result_length == nullptr) {
-    return true;  // Error
-  }
-
-  MacAddr mac;
-  memcpy(&mac, buffer, sizeof(MacAddr));
-
-  // Keep first 3 bytes (OUI), zero last 3 bytes
-  mac.address[3] = 0;
-  mac.address[4] = 0;
-  mac.address[5] = 0;
-
-  memcpy(result_buffer, &mac, sizeof(MacAddr));
-  *result_length = sizeof(MacAddr);
-  return false;  // Success
-}
-
-// ============================================================================
-// Formatting (Abbreviation)
-// ============================================================================
-
-// abbrev(inet) → text
-// Abbreviated display format - omit /32 for IPv4 single hosts
-bool inet_abbrev(const unsigned char *buffer, size_t buffer_size, char *result, size_t result_size, size_t *result_length) {
-  if (buffer == nullptr || buffer_size < sizeof(IPv4Network) || result == nullptr) {
-    return true;  // Error
-  }
-
-  uint8_t family = get_address_family(buffer, buffer_size);
-
-  if (family == AF_INET_VAL && buffer_size >= sizeof(IPv4Network)) {
-    IPv4Network net;
-    memcpy(&net, buffer, sizeof(IPv4Network));
-
-    char addr_str[kMaxIPv4String];
-    format_ipv4_address(net.address, addr_str, sizeof(addr_str));
-
-    // Omit /32 for single host addresses
-    if (net.netmask == 32) {
-      size_t len = strlen(addr_str);
-      if (len + 1 > result_size) return true;
-      strcpy(result, addr_str);
-      *result_length = len;
-    } else {
-      char result_str[kMaxIPv4String];
-      snprintf(result_str, sizeof(result_str), "%s/%u", addr_str, net.netmask);
-      size_t len = strlen(result_str);
-      if (len + 1 > result_size) return true;
-      strcpy(result, result_str);
-      *result_length = len;
-    }
-    return false;  // Success
-
-  } else if (family == AF_INET6_VAL && buffer_size >= sizeof(IPv6Network)) {
-    IPv6Network net;
-    memcpy(&net, buffer, sizeof(IPv6Network));
-
-    char addr_str[kMaxIPv6String];
-    format_ipv6_address(net.address, addr_str, sizeof(addr_str));
-
-    // Omit /128 for single host addresses
-    if (net.netmask == 128) {
-      size_t len = strlen(addr_str);
-      if (len + 1 > result_size) return true;
-      strcpy(result, addr_str);
-      *result_length = len;
-    } else {
-      char result_str[kMaxIPv6String];
-      snprintf(result_str, sizeof(result_str), "%s/%u", addr_str, net.netmask);
-      size_t len = strlen(result_str);
-      if (len + 1 > result_size) return true;
-      strcpy(result, result_str);
-      *result_length = len;
-    }
-    return false;  // Success
-  }
-
-  return true;  // Error: unknown family
-}
-
-// abbrev(cidr) → text
-// Abbreviated display format - show minimal significant octets
-bool cidr_abbrev(const unsigned char *buffer, size_t buffer_size, char *result, size_t result_size, size_t *result_length) {
-  if (buffer == nullptr || buffer_size < sizeof(IPv4Network) || result == nullptr) {
-    return true;  // Error
-  }
-
-  uint8_t family = get_address_family(buffer, buffer_size);
-
-  if (family == AF_INET_VAL && buffer_size >= sizeof(IPv4Network)) {
-    IPv4Network net;
-    memcpy(&net, buffer, sizeof(IPv4Network));
-
-    // Calculate how many octets we need to show based on netmask
-    int significant_octets = (net.netmask + 7) / 8;  // Round up
-    if (significant_octets == 0) significant_octets = 1;  // Show at least first octet
-
-    // Extract octets
-    uint8_t octets[4];
-    octets[0] = (net.address >> 24) & 0xFF;
-    octets[1] = (net.address >> 16) & 0xFF;
-    octets[2] = (net.address >> 8) & 0xFF;
-    octets[3] = net.address & 0xFF;
-
-    // Build abbreviated address string
-    char addr_str[kMaxIPv4String];
-    if (significant_octets == 1) {
-      snprintf(addr_str, sizeof(addr_str), "%u", octets[0]);
-    } else if (significant_octets == 2) {
-      snprintf(addr_str, sizeof(addr_str), "%u.%u", octets[0], octets[1]);
-    } else if (significant_octets == 3) {
-      snprintf(addr_str, sizeof(addr_str), "%u.%u.%u", octets[0], octets[1], octets[2]);
-    } else {
-      snprintf(addr_str, sizeof(addr_str), "%u.%u.%u.%u", octets[0], octets[1], octets[2], octets[3]);
-    }
-
-    char result_str[kMaxIPv4String];
-    snprintf(result_str, sizeof(result_str), "%s/%u", addr_str, net.netmask);
-    size_t len = strlen(result_str);
-    if (len + 1 > result_size) return true;
-    strcpy(result, result_str);
-    *result_length = len;
-    return false;  // Success
-
-  } else if (family == AF_INET6_VAL && buffer_size >= sizeof(IPv6Network)) {
-    // For IPv6, just use the same format as inet_text for now
-    // A more sophisticated implementation would abbreviate groups
-    IPv6Network net;
-    memcpy(&net, buffer, sizeof(IPv6Network));
-
-    char addr_str[kMaxIPv6String];
-    format_ipv6_address(net.address, addr_str, sizeof(addr_str));
-
-    char result_str[kMaxIPv6String];
-    snprintf(result_str, sizeof(result_str), "%s/%u", addr_str, net.netmask);
-    size_t len = strlen(result_str);
-    if (len + 1 > result_size) return true;
-    strcpy(result, result_str);
-    *result_length = len;
-    return false;  // Success
-  }
-
-  return true;  // Error: unknown family
-}
-
-} // namespace network_address
-
-// =============================================================================
-// VEF Registration
-// =============================================================================
-
-// Type name constants (array form required for make_type<> template parameter)
-static constexpr const char kCidrTypeName[] = "CIDR";
-static constexpr const char kInetTypeName[] = "INET";
-static constexpr const char kMacaddrTypeName[] = "MACADDR";
-static constexpr const char kMacaddr8TypeName[] = "MACADDR8";
-
-// =============================================================================
-// Typed encode/decode/compare wrappers for each type
-// These thin wrappers call into the raw-buffer implementations above.
-// They serve as both the type's encode/decode/compare functions and the
-// user-callable cidr_from_string / cidr_to_string VDFs.
-// =============================================================================
-
-// --- CIDR ---
-void encode_cidr(std::string_view from, CustomResult out) {
-  auto buf = out.buffer();
-  size_t length;
-  if (network_address::encode_cidr(
-          buf.data(), buf.size(),
-          from.data(), from.size(), &length)) {
-    out.error("invalid CIDR address");
+  long long value;
+  if (network_address::macaddr_to_bigint(span_data(arg), span_size(arg),
+                                         &value)) {
+    out.warning("macaddr_to_bigint: error");
     return;
   }
-  out.set_length(length);
+  out.set(value);
 }
 
-void decode_cidr(CustomArg in, StringResult out) {
-  if (in.is_null()) {
+void macaddr_from_bigint_impl(IntArg arg, CustomResult out) {
+  NETADDR_STAT_SCOPE("macaddr_from_bigint", arg);
+  if (arg.is_null()) {
     out.set_null();
     return;
   }
-  auto span = in.value();
   auto buf = out.buffer();
-  size_t length;
-  if (network_address::decode_cidr(
-          span.data(), span.size(),
-          buf.data(), buf.size(), &length)) {
-    out.warning("CIDR decode error");
+  size_t bin_len;
+  if (network_address::macaddr_from_bigint(arg.value(), buf.data(),
+                                           &bin_len)) {
+    out.warning("macaddr_from_bigint: value out of range");
     return;
   }
-  out.set_length(length);
-}
-
-int cmp_cidr(CustomArg a, CustomArg b) {
-  auto sa = a.value(), sb = b.value();
-  return network_address::cmp_cidr(
-      sa.data(), sa.size(),
-      sb.data(), sb.size());
+  out.set_length(bin_len);
 }
 
-// --- INET ---
-void encode_inet(std::string_view from, CustomResult out) {
+void inet_abbrev_impl(CustomArg arg, StringResult out) {
+  NETADDR_STAT_SCOPE("inet_abbrev", arg);
+  if (arg.is_null()) {
+    out.set_null();
+    return;
+  }
   auto buf = out.buffer();
-  size_t length;
-  if (network_address::encode_inet(
-          buf.data(), buf.size(),
-          from.data(), from.size(), &length)) {
-    out.error("invalid INET address");
+  size_t str_len;
+  if (network_address::inet_abbrev(span_data(arg), span_size(arg), buf.data(),
+                                   buf.size(), &str_len)) {
+    out.warning("inet_abbrev: error");
     return;
   }
-  out.set_length(length);
+  out.set_length(str_len);
 }
 
-void decode_inet(CustomArg in, StringResult out) {
-  if (in.is_null()) {
+void cidr_abbrev_impl(CustomArg arg, StringResult out) {
+  NETADDR_STAT_SCOPE("cidr_abbrev", arg);
+  if (arg.is_null()) {
     out.set_null();
     return;
   }
-  auto span = in.value();
   auto buf = out.buffer();
-  size_t length;
-  if (network_address::decode_inet(
-          span.data(), span.size(),
-          buf.data(), buf.size(), &length)) {
-    out.warning("INET decode error");
+  size_t str_len;
+  if (network_address::cidr_abbrev(span_data(arg), span_size(arg), buf.data(),
+                                   buf.size(), &str_len)) {
+    out.warning("cidr_abbrev: error");
     return;
   }
-  out.set_length(length);
-}
-
-int cmp_inet(CustomArg a, CustomArg b) {
-  auto sa = a.value(), sb = b.value();
-  return network_address::cmp_inet(
-      sa.data(), sa.size(),
-      sb.data(), sb.size());
+  out.set_length(str_len);
 }
 
-// --- MACADDR ---
-void encode_macaddr(std::string_view from, CustomResult out) {
+void inet_merge_impl(CustomArg a, CustomArg b, CustomResult out) {
+  NETADDR_STAT_SCOPE("inet_merge", a, b);
+  if (a.is_null() || b.is_null()) {
+    out.set_null();
+    return;
+  }
   auto buf = out.buffer();
-  size_t length;
-  if (network_address::encode_macaddr(
-          buf.data(), buf.size(),
-          from.data(), from.size(), &length)) {
-    out.error("invalid MAC address");
+  size_t bin_len;
+  if (network_address::inet_merge(span_data(a), span_size(a), span_data(b),
+                                  span_size(b), buf.data(), &bin_len)) {
+    out.warning("inet_merge: cannot merge addresses from different families");
     return;
   }
-  out.set_length(length);
+  out.set_length(bin_len);
 }
 
-void decode_macaddr(CustomArg in, StringResult out) {
-  if (in.is_null()) {
+void inet_common_prefix_len_impl(CustomArg a, CustomArg b, IntResult out) {
+  NETADDR_STAT_SCOPE("inet_common_prefix_len", a, b);
+  if (a.is_null() || b.is_null()) {
     out.set_null();
     return;
   }
-  auto span = in.value();
-  auto buf = out.buffer();
-  size_t length;
-  if (network_address::decode_macaddr(
-          span.data(), span.size(),
-          buf.data(), buf.size(), &length)) {
-    out.warning("MACADDR decode error");
+  int bits = network_address::inet_common_prefix_len(
+      span_data(a), span_size(a), span_data(b), span_size(b));
+  if (bits < 0) {
+    out.set_null();
     return;
   }
-  out.set_length(length);
-}
-
-int cmp_macaddr(CustomArg a, CustomArg b) {
-  auto sa = a.value(), sb = b.value();
-  return network_address::cmp_macaddr(
-      sa.data(), sa.size(),
-      sb.data(), sb.size());
+  out.set(bits);
 }
 
-// --- MACADDR8 ---
-void encode_macaddr8(std::string_view from, CustomResult out) {
+void inet_xor_distance_impl(CustomArg a, CustomArg b, CustomResult out) {
+  NETADDR_STAT_SCOPE("inet_xor_distance", a, b);
+  if (a.is_null() || b.is_null()) {
+    out.set_null();
+    return;
+  }
   auto buf = out.buffer();
-  size_t length;
-  if (network_address::encode_macaddr8(
-          buf.data(), buf.size(),
-          from.data(), from.size(), &length)) {
-    out.error("invalid MAC address (EUI-64)");
+  size_t bin_len;
+  if (network_address::inet_xor_distance(span_data(a), span_size(a),
+                                         span_data(b), span_size(b),
+                                         buf.data(), &bin_len)) {
+    out.warning("inet_xor_distance: address families differ");
     return;
   }
-  out.set_length(length);
+  out.set_length(bin_len);
 }
 
-void decode_macaddr8(CustomArg in, StringResult out) {
-  if (in.is_null()) {
+void cidr_subnets_impl(CustomArg cidr_arg, IntArg len_arg, IntArg limit_arg,
+                       StringResult out) {
+  NETADDR_STAT_SCOPE("cidr_subnets", cidr_arg, len_arg, limit_arg);
+  if (cidr_arg.is_null() || len_arg.is_null() || limit_arg.is_null()) {
     out.set_null();
     return;
   }
-  auto span = in.value();
   auto buf = out.buffer();
-  size_t length;
-  if (network_address::decode_macaddr8(
-          span.data(), span.size(),
-          buf.data(), buf.size(), &length)) {
-    out.warning("MACADDR8 decode error");
+  size_t str_len;
+  if (network_address::cidr_subnets(
+          span_data(cidr_arg), span_size(cidr_arg), (int)len_arg.value(),
+          limit_arg.value(), buf.data(), buf.size(), &str_len)) {
+    out.warning("cidr_subnets: invalid prefix length or result too large");
     return;
   }
-  out.set_length(length);
-}
-
-int cmp_macaddr8(CustomArg a, CustomArg b) {
-  auto sa = a.value(), sb = b.value();
-  return network_address::cmp_macaddr8(
-      sa.data(), sa.size(),
-      sb.data(), sb.size());
+  out.set_length(str_len);
 }
 
-// VDF wrappers for the from_string conversions: StringArg → CustomResult.
-// These use .warning() (→ NULL) on invalid input, matching PostgreSQL behavior.
-// The type-level encode_* functions use .error() (hard error) so that
-// INSERT with invalid data fails rather than silently storing NULL.
-// Helper: build "failed to parse string 'X'" message matching V1 format.
-static std::string parse_error_msg(std::string_view input) {
-  std::string msg = "failed to parse string '";
-  msg.append(input.data(), input.size());
-  msg += "'";
-  return msg;
+void cidr_hosts_impl(CustomArg cidr_arg, IntArg limit_arg, StringResult out) {
+  NETADDR_STAT_SCOPE("cidr_hosts", cidr_arg, limit_arg);
+  if (cidr_arg.is_null() || limit_arg.is_null()) {
+    out.set_null();
+    return;
+  }
+  auto buf = out.buffer();
+  size_t str_len;
+  if (network_address::cidr_hosts(span_data(cidr_arg), span_size(cidr_arg),
+                                  limit_arg.value(), buf.data(), buf.size(),
+                                  &str_len)) {
+    out.warning("cidr_hosts: invalid limit or result too large");
+    return;
+  }
+  out.set_length(str_len);
 }
 
-void cidr_from_string_vdf(StringArg s, CustomResult out) {
-  if (s.is_null()) {
+void inet_range_to_cidrs_impl(CustomArg start_arg, CustomArg end_arg,
+                              StringResult out) {
+  NETADDR_STAT_SCOPE("inet_range_to_cidrs", start_arg, end_arg);
+  if (start_arg.is_null() || end_arg.is_null()) {
     out.set_null();
     return;
   }
-  auto sv = s.value();
   auto buf = out.buffer();
-  size_t length;
-  if (network_address::encode_cidr(
-          buf.data(), buf.size(), sv.data(),
-          sv.size(), &length)) {
-    out.warning(parse_error_msg(sv));
+  size_t str_len;
+  if (network_address::inet_range_to_cidrs(
+          span_data(start_arg), span_size(start_arg), span_data(end_arg),
+          span_size(end_arg), buf.data(), buf.size(), &str_len)) {
+    out.warning("inet_range_to_cidrs: invalid address range");
     return;
   }
-  out.set_length(length);
+  out.set_length(str_len);
 }
 
-void inet_from_string_vdf(StringArg s, CustomResult out) {
-  if (s.is_null()) {
+void inet_normalize_list_impl(StringArg list_arg, StringArg sep_arg,
+                              StringResult out) {
+  NETADDR_STAT_SCOPE("inet_normalize_list", list_arg, sep_arg);
+  if (list_arg.is_null() || sep_arg.is_null()) {
     out.set_null();
     return;
   }
-  auto sv = s.value();
+  auto list = list_arg.value();
+  auto sep = sep_arg.value();
   auto buf = out.buffer();
-  size_t length;
-  if (network_address::encode_inet(
-          buf.data(), buf.size(), sv.data(),
-          sv.size(), &length)) {
-    out.warning(parse_error_msg(sv));
+  size_t str_len;
+  if (network_address::inet_normalize_list(list.data(), list.size(),
+                                           sep.data(), sep.size(), buf.data(),
+                                           buf.size(), &str_len)) {
+    out.warning("inet_normalize_list: invalid address or result too large");
     return;
   }
-  out.set_length(length);
+  out.set_length(str_len);
 }
 
-void macaddr_from_string_vdf(StringArg s, CustomResult out) {
-  if (s.is_null()) {
+void inet_validate_list_impl(StringArg list_arg, StringArg sep_arg,
+                             IntResult out) {
+  NETADDR_STAT_SCOPE("inet_validate_list", list_arg, sep_arg);
+  if (list_arg.is_null() || sep_arg.is_null()) {
     out.set_null();
     return;
   }
-  auto sv = s.value();
+  auto list = list_arg.value();
+  auto sep = sep_arg.value();
+  out.set(network_address::inet_validate_list(list.data(), list.size(),
+                                              sep.data(), sep.size()));
+}
+
+void inet_sort_list_impl(StringArg list_arg, StringArg sep_arg,
+                         StringResult out) {
+  NETADDR_STAT_SCOPE("inet_sort_list", list_arg, sep_arg);
+  if (list_arg.is_null() || sep_arg.is_null()) {
+    out.set_null();
+    return;
+  }
+  auto list = list_arg.value();
+  auto sep = sep_arg.value();
   auto buf = out.buffer();
-  size_t length;
-  if (network_address::encode_macaddr(
-          buf.data(), buf.size(), sv.data(),
-          sv.size(), &length)) {
-    out.warning(parse_error_msg(sv));
+  size_t str_len;
+  if (network_address::inet_sort_list(list.data(), list.size(), sep.data(),
+                                      sep.size(), buf.data(), buf.size(),
+                                      &str_len)) {
+    out.warning("inet_sort_list: invalid address or result too large");
     return;
   }
-  out.set_length(length);
+  out.set_length(str_len);
 }
 
-void macaddr8_from_string_vdf(StringArg s, CustomResult out) {
-  if (s.is_null()) {
+// Containment test of value against network, compiling network through the
+// caller's per-thread cache
+static void network_includes_cached(
+    network_address::CompiledNetworkCache *cache, CustomArg value,
+    CustomArg network, bool or_equals, IntResult out) {
+  if (value.is_null() || network.is_null()) {
     out.set_null();
     return;
   }
-  auto sv = s.value();
-  auto buf = out.buffer();
-  size_t length;
-  if (network_address::encode_macaddr8(
-          buf.data(), buf.size(), sv.data(),
-          sv.size(), &length)) {
-    out.warning(parse_error_msg(sv));
+  const network_address::CompiledNetwork *compiled =
+      cache->get(span_data(network), span_size(network));
+  if (compiled == nullptr) {
+    out.set_null();
     return;
   }
-  out.set_length(length);
+  int included = network_address::network_includes(
+      *compiled, span_data(value), span_size(value), or_equals);
+  if (included < 0) {
+    out.set_null();
+    return;
+  }
+  out.set(included);
 }
 
-// =============================================================================
-// VDF Wrapper Functions
-// =============================================================================
+void inet_contained_by_impl(CustomArg a, CustomArg b, IntResult out) {
+  NETADDR_STAT_SCOPE("inet_contained_by", a, b);
+  static thread_local network_address::CompiledNetworkCache cache;
+  network_includes_cached(&cache, a, b, false, out);
+}
 
-// Helper: get raw const unsigned char* from CustomArg span
-static inline const unsigned char *span_data(CustomArg arg) {
-  return arg.value().data();
+void inet_contained_by_or_equals_impl(CustomArg a, CustomArg b,
+                                      IntResult out) {
+  NETADDR_STAT_SCOPE("inet_contained_by_or_equals", a, b);
+  static thread_local network_address::CompiledNetworkCache cache;
+  network_includes_cached(&cache, a, b, true, out);
 }
 
-static inline size_t span_size(CustomArg arg) { return arg.value().size(); }
+void inet_contains_impl(CustomArg a, CustomArg b, IntResult out) {
+  NETADDR_STAT_SCOPE("inet_contains", a, b);
+  static thread_local network_address::CompiledNetworkCache cache;
+  network_includes_cached(&cache, b, a, false, out);
+}
 
-void cidr_compare_impl(CustomArg a, CustomArg b, IntResult out) {
-  if (a.is_null() || b.is_null()) { out.set_null(); return; }
-  out.set(cmp_cidr(a, b));
+void inet_contains_or_equals_impl(CustomArg a, CustomArg b, IntResult out) {
+  NETADDR_STAT_SCOPE("inet_contains_or_equals", a, b);
+  static thread_local network_address::CompiledNetworkCache cache;
+  network_includes_cached(&cache, b, a, true, out);
 }
 
-void inet_compare_impl(CustomArg a, CustomArg b, IntResult out) {
-  if (a.is_null() || b.is_null()) { out.set_null(); return; }
-  out.set(cmp_inet(a, b));
+// The same tests with the network side typed CIDR, for CIDR columns and
+// cidr_from_string() constants. CIDR is stored like INET.
+void inet_contained_by_cidr_impl(CustomArg a, CustomArg b, IntResult out) {
+  NETADDR_STAT_SCOPE("inet_contained_by_cidr", a, b);
+  static thread_local network_address::CompiledNetworkCache cache;
+  network_includes_cached(&cache, a, b, false, out);
 }
 
-void macaddr_compare_impl(CustomArg a, CustomArg b, IntResult out) {
-  if (a.is_null() || b.is_null()) { out.set_null(); return; }
-  out.set(cmp_macaddr(a, b));
+void inet_contained_by_or_equals_cidr_impl(CustomArg a, CustomArg b,
+                                           IntResult out) {
+  NETADDR_STAT_SCOPE("inet_contained_by_or_equals_cidr", a, b);
+  static thread_local network_address::CompiledNetworkCache cache;
+  network_includes_cached(&cache, a, b, true, out);
 }
 
-void macaddr8_compare_impl(CustomArg a, CustomArg b, IntResult out) {
-  if (a.is_null() || b.is_null()) { out.set_null(); return; }
-  out.set(cmp_macaddr8(a, b));
+void cidr_contains_impl(CustomArg a, CustomArg b, IntResult out) {
+  NETADDR_STAT_SCOPE("cidr_contains", a, b);
+  static thread_local network_address::CompiledNetworkCache cache;
+  network_includes_cached(&cache, b, a, false, out);
 }
 
-void inet_family_impl(CustomArg arg, IntResult out) {
-  if (arg.is_null()) {
-    out.set_null();
-    return;
-  }
-  int family = network_address::inet_family(span_data(arg), span_size(arg));
-  if (family < 0) {
-    out.set_null();
-    return;
-  }
-  out.set(family);
+void cidr_contains_or_equals_impl(CustomArg a, CustomArg b, IntResult out) {
+  NETADDR_STAT_SCOPE("cidr_contains_or_equals", a, b);
+  static thread_local network_address::CompiledNetworkCache cache;
+  network_includes_cached(&cache, b, a, true, out);
 }
 
-void inet_masklen_impl(CustomArg arg, IntResult out) {
+void inet4_compare_impl(CustomArg a, CustomArg b, IntResult out) {
+  NETADDR_STAT_SCOPE("inet4_compare", a, b);
+  if (a.is_null() || b.is_null()) { out.set_null(); return; }
+  out.set(network_address::cmp_inet4(span_data(a), span_size(a),
+                                     span_data(b), span_size(b)));
+}
+
+void inet4_masklen_impl(CustomArg arg, IntResult out) {
+  NETADDR_STAT_SCOPE("inet4_masklen", arg);
   if (arg.is_null()) {
     out.set_null();
     return;
   }
-  int masklen = network_address::inet_masklen(span_data(arg), span_size(arg));
+  int masklen = network_address::inet4_masklen(span_data(arg), span_size(arg));
   if (masklen < 0) {
     out.set_null();
     return;
@@ -1704,178 +1044,260 @@ void inet_masklen_impl(CustomArg arg, IntResult out) {
   out.set(masklen);
 }
 
-void inet_host_impl(CustomArg arg, StringResult out) {
+void inet4_host_impl(CustomArg arg, StringResult out) {
+  NETADDR_STAT_SCOPE("inet4_host", arg);
   if (arg.is_null()) {
     out.set_null();
     return;
   }
+  unsigned char inet[sizeof(network_address::IPv6Network)];
+  size_t inet_len;
   auto buf = out.buffer();
   size_t str_len;
-  if (network_address::inet_host(span_data(arg), span_size(arg), buf.data(),
-                                 buf.size(), &str_len)) {
-    out.warning("inet_host: error");
+  if (network_address::inet4_to_inet(span_data(arg), span_size(arg), inet,
+                                       &inet_len) ||
+      network_address::inet_host(inet, inet_len, buf.data(), buf.size(),
+                                 &str_len)) {
+    out.warning("inet4_host: error");
     return;
   }
   out.set_length(str_len);
 }
 
-void inet_text_impl(CustomArg arg, StringResult out) {
+void inet4_to_inet_impl(CustomArg arg, CustomResult out) {
+  NETADDR_STAT_SCOPE("inet4_to_inet", arg);
   if (arg.is_null()) {
     out.set_null();
     return;
   }
   auto buf = out.buffer();
-  size_t str_len;
-  if (network_address::inet_text(span_data(arg), span_size(arg), buf.data(),
-                                 buf.size(), &str_len)) {
-    out.warning("inet_text: error");
+  size_t bin_len;
+  if (network_address::inet4_to_inet(span_data(arg), span_size(arg),
+                                       buf.data(), &bin_len)) {
+    out.warning("inet4_to_inet: error");
     return;
   }
-  out.set_length(str_len);
+  out.set_length(bin_len);
 }
 
-void inet_netmask_impl(CustomArg arg, CustomResult out) {
+void inet_to_inet4_impl(CustomArg arg, CustomResult out) {
+  NETADDR_STAT_SCOPE("inet_to_inet4", arg);
   if (arg.is_null()) {
     out.set_null();
     return;
   }
   auto buf = out.buffer();
   size_t bin_len;
-  if (network_address::inet_netmask(
-          span_data(arg), span_size(arg),
-          buf.data(), &bin_len)) {
-    out.warning("inet_netmask: error");
+  if (network_address::inet_to_inet4(span_data(arg), span_size(arg),
+                                       buf.data(), &bin_len)) {
+    out.warning("inet_to_inet4: not an IPv4 address");
     return;
   }
   out.set_length(bin_len);
 }
 
-void inet_hostmask_impl(CustomArg arg, CustomResult out) {
+void inet6_compare_impl(CustomArg a, CustomArg b, IntResult out) {
+  NETADDR_STAT_SCOPE("inet6_compare", a, b);
+  if (a.is_null() || b.is_null()) { out.set_null(); return; }
+  out.set(network_address::cmp_inet6(span_data(a), span_size(a),
+                                     span_data(b), span_size(b)));
+}
+
+void inet6_masklen_impl(CustomArg arg, IntResult out) {
+  NETADDR_STAT_SCOPE("inet6_masklen", arg);
   if (arg.is_null()) {
     out.set_null();
     return;
   }
-  auto buf = out.buffer();
-  size_t bin_len;
-  if (network_address::inet_hostmask(
-          span_data(arg), span_size(arg),
-          buf.data(), &bin_len)) {
-    out.warning("inet_hostmask: error");
+  int masklen = network_address::inet6_masklen(span_data(arg), span_size(arg));
+  if (masklen < 0) {
+    out.set_null();
     return;
   }
-  out.set_length(bin_len);
+  out.set(masklen);
 }
 
-void inet_broadcast_impl(CustomArg arg, CustomResult out) {
+void inet6_host_impl(CustomArg arg, StringResult out) {
+  NETADDR_STAT_SCOPE("inet6_host", arg);
   if (arg.is_null()) {
     out.set_null();
     return;
   }
+  unsigned char inet[sizeof(network_address::IPv6Network)];
+  size_t inet_len;
   auto buf = out.buffer();
-  size_t bin_len;
-  if (network_address::inet_broadcast(
-          span_data(arg), span_size(arg),
-          buf.data(), &bin_len)) {
-    out.warning("inet_broadcast: error");
+  size_t str_len;
+  if (network_address::inet6_to_inet(span_data(arg), span_size(arg), inet,
+                                       &inet_len) ||
+      network_address::inet_host(inet, inet_len, buf.data(), buf.size(),
+                                 &str_len)) {
+    out.warning("inet6_host: error");
     return;
   }
-  out.set_length(bin_len);
+  out.set_length(str_len);
 }
 
-void inet_network_impl(CustomArg arg, CustomResult out) {
+void inet6_to_inet_impl(CustomArg arg, CustomResult out) {
+  NETADDR_STAT_SCOPE("inet6_to_inet", arg);
   if (arg.is_null()) {
     out.set_null();
     return;
   }
   auto buf = out.buffer();
   size_t bin_len;
-  if (network_address::inet_network(
-          span_data(arg), span_size(arg),
-          buf.data(), &bin_len)) {
-    out.warning("inet_network: error");
+  if (network_address::inet6_to_inet(span_data(arg), span_size(arg),
+                                       buf.data(), &bin_len)) {
+    out.warning("inet6_to_inet: error");
     return;
   }
   out.set_length(bin_len);
 }
 
-void inet_set_masklen_impl(CustomArg inet_arg, IntArg len_arg,
-                           CustomResult out) {
-  if (inet_arg.is_null() || len_arg.is_null()) {
+void inet_to_inet6_impl(CustomArg arg, CustomResult out) {
+  NETADDR_STAT_SCOPE("inet_to_inet6", arg);
+  if (arg.is_null()) {
     out.set_null();
     return;
   }
   auto buf = out.buffer();
   size_t bin_len;
-  if (network_address::inet_set_masklen(
-          span_data(inet_arg), span_size(inet_arg), (int)len_arg.value(),
-          buf.data(), &bin_len)) {
-    out.warning("inet_set_masklen: error");
+  if (network_address::inet_to_inet6(span_data(arg), span_size(arg),
+                                       buf.data(), &bin_len)) {
+    out.warning("inet_to_inet6: not an IPv6 address");
     return;
   }
   out.set_length(bin_len);
 }
 
-void cidr_set_masklen_impl(CustomArg cidr_arg, IntArg len_arg,
-                           CustomResult out) {
-  if (cidr_arg.is_null() || len_arg.is_null()) {
+// Administrative functions change server-wide state or read other
+// sessions' input text, and the SDK has no privilege check to offer, so
+// they only run when whoever starts the server sets
+// VSQL_NETWORK_ADDRESS_ADMIN to anything but "0" in its environment.
+// Otherwise they warn and return NULL.
+static bool admin_functions_enabled() {
+  static const bool enabled = [] {
+    const char *value = getenv("VSQL_NETWORK_ADDRESS_ADMIN");
+    return value != nullptr && *value != '\0' && strcmp(value, "0") != 0;
+  }();
+  return enabled;
+}
+
+template <class Result>
+static bool admin_refused(const char *fname, Result &out) {
+  if (admin_functions_enabled()) {
+    return false;
+  }
+  out.warning(std::string(fname) +
+              ": disabled; set VSQL_NETWORK_ADDRESS_ADMIN=1 in the server "
+              "environment");
+  return true;
+}
+
+// Parse and format cache controls. The toggles are process-wide; each
+// returns the previous setting so a session can restore it.
+static void cache_toggle(const char *fname, bool (*set_enabled)(bool),
+                         IntArg enable_arg, IntResult out) {
+  if (admin_refused(fname, out)) {
+    return;
+  }
+  if (enable_arg.is_null()) {
     out.set_null();
     return;
   }
+  out.set(set_enabled(enable_arg.value() != 0) ? 1 : 0);
+}
+
+static void cache_stats(const char *fname, bool enabled,
+                        const network_address::CacheStats &stats,
+                        StringResult out) {
   auto buf = out.buffer();
-  size_t bin_len;
-  if (network_address::cidr_set_masklen(
-          span_data(cidr_arg), span_size(cidr_arg), (int)len_arg.value(),
-          buf.data(), &bin_len)) {
-    out.warning("cidr_set_masklen: error");
+  int n = snprintf(buf.data(), buf.size(),
+                   "{\"enabled\": %d, \"hits\": %llu, \"misses\": %llu, "
+                   "\"evictions\": %llu}",
+                   enabled ? 1 : 0, (unsigned long long)stats.hits,
+                   (unsigned long long)stats.misses,
+                   (unsigned long long)stats.evictions);
+  if (n < 0 || (size_t)n >= buf.size()) {
+    out.warning(std::string(fname) + ": error");
     return;
   }
-  out.set_length(bin_len);
+  out.set_length(n);
 }
 
-void macaddr_trunc_impl(CustomArg arg, CustomResult out) {
-  if (arg.is_null()) {
-    out.set_null();
+void netaddr_parse_cache_impl(IntArg enable_arg, IntResult out) {
+  cache_toggle("netaddr_parse_cache",
+               &network_address::set_parse_cache_enabled, enable_arg, out);
+}
+
+void netaddr_parse_cache_stats_impl(StringResult out) {
+  cache_stats("netaddr_parse_cache_stats",
+              network_address::parse_cache_enabled(),
+              network_address::parse_cache_stats(), out);
+}
+
+void netaddr_format_cache_impl(IntArg enable_arg, IntResult out) {
+  cache_toggle("netaddr_format_cache",
+               &network_address::set_format_cache_enabled, enable_arg, out);
+}
+
+void netaddr_format_cache_stats_impl(StringResult out) {
+  cache_stats("netaddr_format_cache_stats",
+              network_address::format_cache_enabled(),
+              network_address::format_cache_stats(), out);
+}
+
+// Call statistics as JSON (see NETADDR_STAT_SCOPE); reset starts every
+// count over from zero and returns 1
+void netaddr_stats_impl(StringResult out) {
+  auto buf = out.buffer();
+  size_t length;
+  if (network_address::stats_json(buf.data(), buf.size(), &length)) {
+    out.warning("netaddr_stats: result too large");
     return;
   }
-  auto buf = out.buffer();
-  size_t bin_len;
-  if (network_address::macaddr_trunc(
-          span_data(arg), span_size(arg),
-          buf.data(), &bin_len)) {
-    out.warning("macaddr_trunc: error");
+  out.set_length(length);
+}
+
+void netaddr_stats_reset_impl(IntResult out) {
+  if (admin_refused("netaddr_stats_reset", out)) {
     return;
   }
-  out.set_length(bin_len);
+  network_address::reset_stats();
+  out.set(1);
 }
 
-void inet_abbrev_impl(CustomArg arg, StringResult out) {
-  if (arg.is_null()) {
-    out.set_null();
+// Sampled recent rejections as JSON; the sampling control sets one in how
+// many rejections per thread is recorded (0 stops) and returns the
+// previous period. The ring holds text from every session, so both are
+// administrative.
+void netaddr_recent_rejects_impl(StringResult out) {
+  if (admin_refused("netaddr_recent_rejects", out)) {
     return;
   }
   auto buf = out.buffer();
-  size_t str_len;
-  if (network_address::inet_abbrev(span_data(arg), span_size(arg), buf.data(),
-                                   buf.size(), &str_len)) {
-    out.warning("inet_abbrev: error");
+  size_t length;
+  if (network_address::recent_rejects_json(buf.data(), buf.size(), &length)) {
+    out.warning("netaddr_recent_rejects: result too large");
     return;
   }
-  out.set_length(str_len);
+  out.set_length(length);
 }
 
-void cidr_abbrev_impl(CustomArg arg, StringResult out) {
-  if (arg.is_null()) {
+void netaddr_reject_sampling_impl(IntArg period_arg, IntResult out) {
+  if (admin_refused("netaddr_reject_sampling", out)) {
+    return;
+  }
+  if (period_arg.is_null()) {
     out.set_null();
     return;
   }
-  auto buf = out.buffer();
-  size_t str_len;
-  if (network_address::cidr_abbrev(span_data(arg), span_size(arg), buf.data(),
-                                   buf.size(), &str_len)) {
-    out.warning("cidr_abbrev: error");
+  long long period = period_arg.value();
+  if (period < 0 || period > UINT32_MAX) {
+    out.warning("netaddr_reject_sampling: period out of range");
     return;
   }
-  out.set_length(str_len);
+  out.set(network_address::set_reject_sample_period(
+      static_cast<uint32_t>(period)));
 }
 
 // =============================================================================
@@ -1918,12 +1340,32 @@ constexpr auto MACADDR8 = make_type<kMacaddr8TypeName>()
                               .intrinsic_default_str("00:00:00:00:00:00:00:00")
                               .build();
 
+constexpr auto INET4 = make_type<kInet4TypeName>()
+                           .persisted_length(5)
+                           .max_decode_buffer_length(64)
+                           .from_string<&encode_inet4>()
+                           .to_string<&decode_inet4>()
+                           .compare<&cmp_inet4>()
+                           .intrinsic_default_str("0.0.0.0")
+                           .build();
+
+constexpr auto INET6 = make_type<kInet6TypeName>()
+                           .persisted_length(17)
+                           .max_decode_buffer_length(64)
+                           .from_string<&encode_inet6>()
+                           .to_string<&decode_inet6>()
+                           .compare<&cmp_inet6>()
+                           .intrinsic_default_str("::")
+                           .build();
+
 VEF_GENERATE_ENTRY_POINTS(
     make_extension()
         .type(CIDR)
         .type(INET)
         .type(MACADDR)
         .type(MACADDR8)
+        .type(INET4)
+        .type(INET6)
 
         // Explicit conversion VDFs
         .func(make_func<&cidr_from_string_vdf>("cidr_from_string")
@@ -2049,6 +1491,15 @@ VEF_GENERATE_ENTRY_POINTS(
                   .param(MACADDR)
                   .buffer_size(6)
                   .build())
+        .func(make_func<&macaddr_to_bigint_impl>("macaddr_to_bigint")
+                  .returns(INT)
+                  .param(MACADDR)
+                  .build())
+        .func(make_func<&macaddr_from_bigint_impl>("macaddr_from_bigint")
+                  .returns(MACADDR)
+                  .param(INT)
+                  .buffer_size(6)
+                  .build())
 
         // Formatting
         .func(make_func<&inet_abbrev_impl>("inet_abbrev")
@@ -2060,4 +1511,255 @@ VEF_GENERATE_ENTRY_POINTS(
                   .returns(STRING)
                   .param(CIDR)
                   .buffer_size(64)
+                  .build())
+
+        // Prefix arithmetic
+        .func(make_func<&inet_merge_impl>("inet_merge")
+                  .returns(CIDR)
+                  .param(INET)
+                  .param(INET)
+                  .buffer_size(19)
+                  .build())
+        .func(make_func<&inet_common_prefix_len_impl>("inet_common_prefix_len")
+                  .returns(INT)
+                  .param(INET)
+                  .param(INET)
+                  .build())
+        .func(make_func<&inet_xor_distance_impl>("inet_xor_distance")
+                  .returns(INET)
+                  .param(INET)
+                  .param(INET)
+                  .buffer_size(19)
+                  .build())
+
+        // Containment
+        .func(make_func<&inet_contained_by_impl>("inet_contained_by")
+                  .returns(INT)
+                  .param(INET)
+                  .param(INET)
+                  .build())
+        .func(make_func<&inet_contained_by_or_equals_impl>(
+                  "inet_contained_by_or_equals")
+                  .returns(INT)
+                  .param(INET)
+                  .param(INET)
+                  .build())
+        .func(make_func<&inet_contains_impl>("inet_contains")
+                  .returns(INT)
+                  .param(INET)
+                  .param(INET)
+                  .build())
+        .func(make_func<&inet_contains_or_equals_impl>("inet_contains_or_equals")
+                  .returns(INT)
+                  .param(INET)
+                  .param(INET)
+                  .build())
+        .func(make_func<&inet_contained_by_cidr_impl>("inet_contained_by_cidr")
+                  .returns(INT)
+                  .param(INET)
+                  .param(CIDR)
+                  .build())
+        .func(make_func<&inet_contained_by_or_equals_cidr_impl>(
+                  "inet_contained_by_or_equals_cidr")
+                  .returns(INT)
+                  .param(INET)
+                  .param(CIDR)
+                  .build())
+        .func(make_func<&cidr_contains_impl>("cidr_contains")
+                  .returns(INT)
+                  .param(CIDR)
+                  .param(INET)
+                  .build())
+        .func(make_func<&cidr_contains_or_equals_impl>("cidr_contains_or_equals")
+                  .returns(INT)
+                  .param(CIDR)
+                  .param(INET)
+                  .build())
+
+        // Enumeration
+        .func(make_func<&cidr_subnets_impl>("cidr_subnets")
+                  .returns(STRING)
+                  .param(CIDR)
+                  .param(INT)
+                  .param(INT)
+                  .buffer_size(network_address::kMaxAddressList)
+                  .build())
+        .func(make_func<&cidr_hosts_impl>("cidr_hosts")
+                  .returns(STRING)
+                  .param(CIDR)
+                  .param(INT)
+                  .buffer_size(network_address::kMaxAddressList)
+                  .build())
+        .func(make_func<&inet_range_to_cidrs_impl>("inet_range_to_cidrs")
+                  .returns(STRING)
+                  .param(INET)
+                  .param(INET)
+                  .buffer_size(network_address::kMaxAddressList)
+                  .build())
+
+        // Address lists
+        .func(make_func<&inet_normalize_list_impl>("inet_normalize_list")
+                  .returns(STRING)
+                  .param(STRING)
+                  .param(STRING)
+                  .buffer_size(network_address::kMaxAddressList)
+                  .build())
+        .func(make_func<&inet_validate_list_impl>("inet_validate_list")
+                  .returns(INT)
+                  .param(STRING)
+                  .param(STRING)
+                  .build())
+        .func(make_func<&inet_sort_list_impl>("inet_sort_list")
+                  .returns(STRING)
+                  .param(STRING)
+                  .param(STRING)
+                  .buffer_size(network_address::kMaxAddressList)
+                  .build())
+
+        // Silent validation
+        .func(make_func<&cidr_is_valid_impl>("cidr_is_valid")
+                  .returns(INT)
+                  .param(STRING)
+                  .build())
+        .func(make_func<&inet_is_valid_impl>("inet_is_valid")
+                  .returns(INT)
+                  .param(STRING)
+                  .build())
+        .func(make_func<&macaddr_is_valid_impl>("macaddr_is_valid")
+                  .returns(INT)
+                  .param(STRING)
+                  .build())
+        .func(make_func<&macaddr8_is_valid_impl>("macaddr8_is_valid")
+                  .returns(INT)
+                  .param(STRING)
+                  .build())
+        .func(make_func<&try_cidr_from_string_impl>("try_cidr_from_string")
+                  .returns(CIDR)
+                  .param(STRING)
+                  .buffer_size(19)
+                  .build())
+        .func(make_func<&try_inet_from_string_impl>("try_inet_from_string")
+                  .returns(INET)
+                  .param(STRING)
+                  .buffer_size(19)
+                  .build())
+        .func(make_func<&try_macaddr_from_string_impl>("try_macaddr_from_string")
+                  .returns(MACADDR)
+                  .param(STRING)
+                  .buffer_size(6)
+                  .build())
+        .func(make_func<&try_macaddr8_from_string_impl>("try_macaddr8_from_string")
+                  .returns(MACADDR8)
+                  .param(STRING)
+                  .buffer_size(8)
+                  .build())
+
+        // Compact single-family types
+        .func(make_func<&inet4_from_string_vdf>("inet4_from_string")
+                  .returns(INET4)
+                  .param(STRING)
+                  .buffer_size(5)
+                  .build())
+        .func(make_func<&decode_inet4>("inet4_to_string")
+                  .returns(STRING)
+                  .param(INET4)
+                  .buffer_size(64)
+                  .build())
+        .func(make_func<&inet4_compare_impl>("inet4_compare")
+                  .returns(INT)
+                  .param(INET4)
+                  .param(INET4)
+                  .build())
+        .func(make_func<&inet4_masklen_impl>("inet4_masklen")
+                  .returns(INT)
+                  .param(INET4)
+                  .build())
+        .func(make_func<&inet4_host_impl>("inet4_host")
+                  .returns(STRING)
+                  .param(INET4)
+                  .buffer_size(64)
+                  .build())
+        .func(make_func<&inet4_to_inet_impl>("inet4_to_inet")
+                  .returns(INET)
+                  .param(INET4)
+                  .buffer_size(19)
+                  .build())
+        .func(make_func<&inet_to_inet4_impl>("inet_to_inet4")
+                  .returns(INET4)
+                  .param(INET)
+                  .buffer_size(5)
+                  .build())
+        .func(make_func<&inet6_from_string_vdf>("inet6_from_string")
+                  .returns(INET6)
+                  .param(STRING)
+                  .buffer_size(17)
+                  .build())
+        .func(make_func<&decode_inet6>("inet6_to_string")
+                  .returns(STRING)
+                  .param(INET6)
+                  .buffer_size(64)
+                  .build())
+        .func(make_func<&inet6_compare_impl>("inet6_compare")
+                  .returns(INT)
+                  .param(INET6)
+                  .param(INET6)
+                  .build())
+        .func(make_func<&inet6_masklen_impl>("inet6_masklen")
+                  .returns(INT)
+                  .param(INET6)
+                  .build())
+        .func(make_func<&inet6_host_impl>("inet6_host")
+                  .returns(STRING)
+                  .param(INET6)
+                  .buffer_size(64)
+                  .build())
+        .func(make_func<&inet6_to_inet_impl>("inet6_to_inet")
+                  .returns(INET)
+                  .param(INET6)
+                  .buffer_size(19)
+                  .build())
+        .func(make_func<&inet_to_inet6_impl>("inet_to_inet6")
+                  .returns(INET6)
+                  .param(INET)
+                  .buffer_size(17)
+                  .build())
+
+        // Parse and format caches
+        .func(make_func<&netaddr_parse_cache_impl>("netaddr_parse_cache")
+                  .returns(INT)
+                  .param(INT)
+                  .build())
+        .func(make_func<&netaddr_parse_cache_stats_impl>(
+                  "netaddr_parse_cache_stats")
+                  .returns(STRING)
+                  .buffer_size(128)
+                  .build())
+        .func(make_func<&netaddr_format_cache_impl>("netaddr_format_cache")
+                  .returns(INT)
+                  .param(INT)
+                  .build())
+        .func(make_func<&netaddr_format_cache_stats_impl>(
+                  "netaddr_format_cache_stats")
+                  .returns(STRING)
+                  .buffer_size(128)
+                  .build())
+
+        // Call statistics
+        .func(make_func<&netaddr_stats_impl>("netaddr_stats")
+                  .returns(STRING)
+                  .buffer_size(network_address::kMaxStatsJson)
+                  .build())
+        .func(make_func<&netaddr_stats_reset_impl>("netaddr_stats_reset")
+                  .returns(INT)
+                  .build())
+
+        // Recently rejected input text
+        .func(make_func<&netaddr_recent_rejects_impl>("netaddr_recent_rejects")
+                  .returns(STRING)
+                  .buffer_size(network_address::kMaxRejectsJson)
+                  .build())
+        .func(make_func<&netaddr_reject_sampling_impl>(
+                  "netaddr_reject_sampling")
+                  .returns(INT)
+                  .param(INT)
                   .build()))
@@ -0,0 +1,3562 @@
+/* Copyright (c) 2025 VillageSQL Contributors
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "network_address_core.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cctype>
+#include <chrono>
+#include <cstdarg>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <stdio.h>
+#include <string_view>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+// x86-64 kernels that need more than the SSE2 baseline are compiled per
+// function with a target attribute and chosen at run time
+#if defined(__x86_64__) && defined(__GNUC__)
+#define NETWORK_ADDRESS_X86_DISPATCH 1
+#include <tmmintrin.h>
+#endif
+
+// USDT probes of provider vsql_network_address on the public encode_*,
+// decode_* and cmp_* functions (NETWORK_ADDRESS_USDT, needs sys/sdt.h).
+// Every probe has a semaphore that bpftrace, perf or SystemTap raise while
+// attached: an unwatched probe is one compare of that counter and a branch
+// around the probe's nop, and its arguments are never computed.
+#if NETWORK_ADDRESS_USDT
+#define _SDT_HAS_SEMAPHORES 1
+#include <sys/sdt.h>
+
+#define NETADDR_PROBE_SEMAPHORE(name)                                    \
+  __extension__ unsigned short vsql_network_address_##name##_semaphore \
+      __attribute__((used, section(".probes")))
+
+NETADDR_PROBE_SEMAPHORE(encode__entry);
+NETADDR_PROBE_SEMAPHORE(encode__return);
+NETADDR_PROBE_SEMAPHORE(decode__entry);
+NETADDR_PROBE_SEMAPHORE(decode__return);
+NETADDR_PROBE_SEMAPHORE(compare__entry);
+NETADDR_PROBE_SEMAPHORE(compare__return);
+
+// The semaphore is written by the tracer, so it is read afresh every call
+#define NETADDR_PROBE(name, ...)                                           \
+  do {                                                                     \
+    if (__builtin_expect(                                                  \
+            *static_cast<volatile unsigned short *>(                       \
+                &vsql_network_address_##name##_semaphore) != 0,            \
+            0)) {                                                          \
+      STAP_PROBEV(vsql_network_address, name, __VA_ARGS__);               \
+    }                                                                      \
+  } while (0)
+#endif
+
+namespace network_address {
+
+// ============================================================================
+// SIMD Kernels
+// ============================================================================
+
+namespace {
+
+// Longest strict dotted quad, "255.255.255.255"
+constexpr size_t kMaxDottedQuad = 15;
+
+// Strict dotted quad: four decimal octets of one to three digits separated
+// by single dots, nothing else. False for signs, spaces, longer digit runs,
+// trailing text and octets above 255.
+bool parse_ipv4_dotted_scalar(const char *text, size_t length,
+                              uint32_t *address) {
+  uint32_t result = 0;
+  size_t at = 0;
+  for (int octet = 0; octet < 4; ++octet) {
+    if (octet > 0) {
+      if (at >= length || text[at] != '.') {
+        return false;
+      }
+      ++at;
+    }
+    const size_t start = at;
+    uint32_t value = 0;
+    while (at < length && at - start < 3 &&
+           static_cast<unsigned>(text[at] - '0') <= 9) {
+      value = value * 10 + static_cast<uint32_t>(text[at] - '0');
+      ++at;
+    }
+    if (at == start || value > 255) {
+      return false;
+    }
+    result = (result << 8) | value;
+  }
+  if (at != length) {
+    return false;
+  }
+  *address = result;
+  return true;
+}
+
+#ifdef NETWORK_ADDRESS_X86_DISPATCH
+// pshufb masks that move the digits of each octet into a 4-byte lane as
+// hundreds, tens, ones, zero. Indexed by the octet lengths (1-3 each) read
+// as base-3 digits; 0x80 selects a zero byte.
+struct IPv4ShuffleTable {
+  alignas(16) uint8_t mask[81][16];
+
+  constexpr IPv4ShuffleTable() : mask() {
+    for (int index = 0; index < 81; ++index) {
+      const int lengths[4] = {index / 27 % 3 + 1, index / 9 % 3 + 1,
+                              index / 3 % 3 + 1, index % 3 + 1};
+      int start = 0;
+      for (int octet = 0; octet < 4; ++octet) {
+        for (int slot = 0; slot < 4; ++slot) {
+          const int digit = slot - (3 - lengths[octet]);
+          mask[index][octet * 4 + slot] = static_cast<uint8_t>(
+              slot < 3 && digit >= 0 ? start + digit : 0x80);
+        }
+        start += lengths[octet] + 1;
+      }
+    }
+  }
+};
+
+constexpr IPv4ShuffleTable kIPv4Shuffles{};
+
+// pshufb masks, indexed by length, that rebuild the text from two
+// overlapping loads (see load_dotted_quad) and zero the lanes past its end
+struct IPv4GatherTable {
+  alignas(16) uint8_t mask[kMaxDottedQuad + 1][16];
+
+  constexpr IPv4GatherTable() : mask() {
+    for (size_t length = 0; length <= kMaxDottedQuad; ++length) {
+      const size_t half = length >= 8 ? 8 : 4;
+      for (size_t i = 0; i < 16; ++i) {
+        size_t lane = 0x80;
+        if (i < half) {
+          lane = i;
+        } else if (i < length) {
+          lane = i + 2 * half - length;
+        }
+        mask[length][i] = static_cast<uint8_t>(lane);
+      }
+    }
+  }
+};
+
+constexpr IPv4GatherTable kIPv4Gathers{};
+
+// Load 7-15 characters into a zero-padded vector without reading past the
+// end: two loads of half a vector that overlap in the middle, merged by a
+// shuffle. Avoids a copy through memory, whose store-to-load forwarding
+// stall would cost more than the parse.
+__attribute__((target("ssse3")))
+__m128i load_dotted_quad(const char *text, size_t length) {
+  __m128i halves;
+  if (length >= 8) {
+    halves = _mm_unpacklo_epi64(
+        _mm_loadl_epi64(reinterpret_cast<const __m128i *>(text)),
+        _mm_loadl_epi64(reinterpret_cast<const __m128i *>(text + length - 8)));
+  } else {
+    uint32_t head, tail;
+    memcpy(&head, text, sizeof(head));
+    memcpy(&tail, text + length - 4, sizeof(tail));
+    halves = _mm_unpacklo_epi32(_mm_cvtsi32_si128(static_cast<int>(head)),
+                                _mm_cvtsi32_si128(static_cast<int>(tail)));
+  }
+  return _mm_shuffle_epi8(
+      halves, _mm_load_si128(reinterpret_cast<const __m128i *>(
+                  kIPv4Gathers.mask[length])));
+}
+
+// Same contract as parse_ipv4_dotted_scalar. One 16-byte compare finds the
+// dots and checks every other character is a digit; the dot positions pick
+// a shuffle that lines the digits up for a multiply-add into four octets.
+__attribute__((target("ssse3")))
+bool parse_ipv4_dotted_ssse3(const char *text, size_t length,
+                             uint32_t *address) {
+  if (length < 7 || length > kMaxDottedQuad) {
+    return false;
+  }
+  const __m128i c = load_dotted_quad(text, length);
+  const __m128i d = _mm_sub_epi8(c, _mm_set1_epi8('0'));
+  const __m128i is_digit = _mm_cmpeq_epi8(_mm_min_epu8(d, _mm_set1_epi8(9)), d);
+  const __m128i is_dot = _mm_cmpeq_epi8(c, _mm_set1_epi8('.'));
+  // Padding lanes are zero, so they must come out as neither
+  const unsigned used = (1u << length) - 1;
+  if (static_cast<unsigned>(_mm_movemask_epi8(_mm_or_si128(is_digit, is_dot))) !=
+      used) {
+    return false;
+  }
+  unsigned dots = static_cast<unsigned>(_mm_movemask_epi8(is_dot));
+  const unsigned dot0 = __builtin_ctz(dots | 0x10000);
+  dots &= dots - 1;
+  const unsigned dot1 = __builtin_ctz(dots | 0x10000);
+  dots &= dots - 1;
+  const unsigned dot2 = __builtin_ctz(dots | 0x10000);
+  if ((dots & (dots - 1)) != 0) {
+    return false; // More than three dots
+  }
+  // Octet length minus one; anything above 2 (or an empty octet, which
+  // wraps) leaves the strict form
+  const unsigned l0 = dot0 - 1;
+  const unsigned l1 = dot1 - dot0 - 2;
+  const unsigned l2 = dot2 - dot1 - 2;
+  const unsigned l3 = static_cast<unsigned>(length) - dot2 - 2;
+  if (l0 > 2 || l1 > 2 || l2 > 2 || l3 > 2) {
+    return false;
+  }
+
+  const __m128i shuffle = _mm_load_si128(reinterpret_cast<const __m128i *>(
+      kIPv4Shuffles.mask[((l0 * 3 + l1) * 3 + l2) * 3 + l3]));
+  const __m128i digits = _mm_shuffle_epi8(d, shuffle);
+  const __m128i pairs = _mm_maddubs_epi16(
+      digits, _mm_setr_epi8(100, 10, 1, 0, 100, 10, 1, 0, 100, 10, 1, 0, 100,
+                            10, 1, 0));
+  const __m128i octets = _mm_madd_epi16(pairs, _mm_set1_epi16(1));
+  if (_mm_movemask_epi8(_mm_cmpgt_epi32(octets, _mm_set1_epi32(255))) != 0) {
+    return false;
+  }
+  const __m128i bytes = _mm_packus_epi16(_mm_packs_epi32(octets, octets),
+                                         _mm_setzero_si128());
+  *address = __builtin_bswap32(static_cast<uint32_t>(_mm_cvtsi128_si32(bytes)));
+  return true;
+}
+#endif
+
+
+constexpr char kHexDigits[] = "0123456789abcdef";
+
+// Lowercase hex text of up to 16 bytes with a ':' after every group of
+// bytes: "2001:0db8:..." (group 2) or "08:00:2b:..." (group 1). For the
+// vector path, digits[k][s] is the byte shuffle that takes output chunk k
+// (16 characters) from digit vector s (32 digits in two vectors) and seps[k]
+// the separators ORed in; lanes past the end come out as NUL.
+struct HexLayout {
+  static constexpr size_t kChunks = 3;
+
+  uint8_t digits[kChunks][2][16];
+  uint8_t seps[kChunks][16];
+  int bytes;
+  int group;
+  size_t length;
+
+  constexpr HexLayout(int bytes_, int group_)
+      : digits(), seps(), bytes(bytes_), group(group_),
+        length(static_cast<size_t>(2 * bytes_ + bytes_ / group_ - 1)) {
+    const size_t period = static_cast<size_t>(2 * group_ + 1);
+    for (size_t i = 0; i < kChunks * 16; ++i) {
+      uint8_t *from_a = &digits[i / 16][0][i % 16];
+      uint8_t *from_b = &digits[i / 16][1][i % 16];
+      *from_a = *from_b = 0x80;
+      if (i >= length) {
+        continue;
+      }
+      if (i % period == period - 1) {
+        seps[i / 16][i % 16] = ':';
+        continue;
+      }
+      const size_t digit = i - i / period;
+      if (digit < 16) {
+        *from_a = static_cast<uint8_t>(digit);
+      } else {
+        *from_b = static_cast<uint8_t>(digit - 16);
+      }
+    }
+  }
+};
+
+constexpr HexLayout kIPv6Hex(16, 2);
+constexpr HexLayout kMacHex(6, 1);
+constexpr HexLayout kMac8Hex(8, 1);
+
+void format_hex_scalar(const uint8_t *bytes, const HexLayout &layout,
+                       char *out) {
+  for (int i = 0; i < layout.bytes; ++i) {
+    if (i > 0 && i % layout.group == 0) {
+      *out++ = ':';
+    }
+    *out++ = kHexDigits[bytes[i] >> 4];
+    *out++ = kHexDigits[bytes[i] & 0x0F];
+  }
+  *out = '\0';
+}
+
+// The 6 or 8 bytes of a MAC address in the low bytes of a word, as they
+// sit in memory (little-endian targets), without a variable-size memcpy
+inline uint64_t load_mac_word(const uint8_t *bytes, int count) {
+  uint64_t word;
+  if (count == 8) {
+    memcpy(&word, bytes, 8);
+    return word;
+  }
+  uint32_t head;
+  uint16_t tail;
+  memcpy(&head, bytes, 4);
+  memcpy(&tail, bytes + 4, 2);
+  return head | static_cast<uint64_t>(tail) << 32;
+}
+
+#if defined(__SSE2__)
+// Store the first size (< 16) bytes of chunk, none past them
+void store_partial_sse2(char *out, __m128i chunk, size_t size) {
+  if (size >= 8) {
+    _mm_storel_epi64(reinterpret_cast<__m128i *>(out), chunk);
+    chunk = _mm_srli_si128(chunk, 8);
+    out += 8;
+    size -= 8;
+  }
+  uint32_t word = static_cast<uint32_t>(_mm_cvtsi128_si32(chunk));
+  if (size >= 4) {
+    memcpy(out, &word, 4);
+    word = static_cast<uint32_t>(_mm_cvtsi128_si32(_mm_srli_si128(chunk, 4)));
+    out += 4;
+    size -= 4;
+  }
+  if (size >= 2) {
+    const uint16_t half = static_cast<uint16_t>(word);
+    memcpy(out, &half, 2);
+    word >>= 16;
+    out += 2;
+    size -= 2;
+  }
+  if (size >= 1) {
+    *out = static_cast<char>(word);
+  }
+}
+#endif
+
+#ifdef NETWORK_ADDRESS_X86_DISPATCH
+// Nibbles become digits through a pshufb lookup; the layout shuffles then
+// place all digits and separators, a chunk of 16 characters at a time.
+__attribute__((target("ssse3")))
+void format_hex_ssse3(const uint8_t *bytes, const HexLayout &layout,
+                      char *out) {
+  __m128i v;
+  if (layout.bytes == 16) {
+    v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(bytes));
+  } else {
+    v = _mm_cvtsi64_si128(static_cast<long long>(load_mac_word(bytes, layout.bytes)));
+  }
+  const __m128i lut = _mm_loadu_si128(reinterpret_cast<const __m128i *>(kHexDigits));
+  const __m128i low_nibble = _mm_set1_epi8(0x0F);
+  const __m128i hi = _mm_and_si128(_mm_srli_epi16(v, 4), low_nibble);
+  const __m128i lo = _mm_and_si128(v, low_nibble);
+  const __m128i a = _mm_shuffle_epi8(lut, _mm_unpacklo_epi8(hi, lo));
+  const __m128i b = _mm_shuffle_epi8(lut, _mm_unpackhi_epi8(hi, lo));
+
+  // Text plus its NUL, one chunk of 16 characters at a time
+  const size_t size = layout.length + 1;
+  for (size_t at = 0; at < size; at += 16) {
+    const __m128i *masks =
+        reinterpret_cast<const __m128i *>(layout.digits[at / 16]);
+    const __m128i chunk = _mm_or_si128(
+        _mm_or_si128(_mm_shuffle_epi8(a, _mm_loadu_si128(masks)),
+                     _mm_shuffle_epi8(b, _mm_loadu_si128(masks + 1))),
+        _mm_loadu_si128(
+            reinterpret_cast<const __m128i *>(layout.seps[at / 16])));
+    if (size - at >= 16) {
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(out + at), chunk);
+    } else {
+      store_partial_sse2(out + at, chunk, size - at);
+    }
+  }
+}
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+// Same as the SSSE3 version, with tbl for the lookups and shuffles
+void format_hex_neon(const uint8_t *bytes, const HexLayout &layout,
+                     char *out) {
+  const uint8x16_t v =
+      layout.bytes == 16
+          ? vld1q_u8(bytes)
+          : vcombine_u8(vcreate_u8(load_mac_word(bytes, layout.bytes)),
+                        vdup_n_u8(0));
+  const uint8x16_t lut = vld1q_u8(reinterpret_cast<const uint8_t *>(kHexDigits));
+  const uint8x16x2_t nibbles =
+      vzipq_u8(vshrq_n_u8(v, 4), vandq_u8(v, vdupq_n_u8(0x0F)));
+  const uint8x16_t a = vqtbl1q_u8(lut, nibbles.val[0]);
+  const uint8x16_t b = vqtbl1q_u8(lut, nibbles.val[1]);
+
+  const size_t size = layout.length + 1;
+  for (size_t at = 0; at < size; at += 16) {
+    const uint8x16_t chunk =
+        vorrq_u8(vorrq_u8(vqtbl1q_u8(a, vld1q_u8(layout.digits[at / 16][0])),
+                          vqtbl1q_u8(b, vld1q_u8(layout.digits[at / 16][1]))),
+                 vld1q_u8(layout.seps[at / 16]));
+    if (size - at >= 16) {
+      vst1q_u8(reinterpret_cast<uint8_t *>(out + at), chunk);
+    } else {
+      uint8_t rest[16];
+      vst1q_u8(rest, chunk);
+      memcpy(out + at, rest, size - at);
+    }
+  }
+}
+#endif
+
+// A fixed MAC text layout, built from a pattern where 'x' is a hex digit and
+// any other character a separator. cls holds the class each position must
+// have (1 = hex digit, 2 = separator, 0 = past the end) and digit[i] the
+// position of the high nibble of byte i.
+struct MacLayout {
+  static constexpr size_t kWidth = 32;
+
+  uint8_t cls[kWidth];
+  uint8_t digit[8];
+  size_t length;
+  int bytes;
+
+  constexpr MacLayout(const char *pattern)
+      : cls(), digit(), length(0), bytes(0) {
+    int digits = 0;
+    for (; pattern[length] != '\0'; ++length) {
+      if (pattern[length] != 'x') {
+        cls[length] = 2;
+        continue;
+      }
+      cls[length] = 1;
+      if (digits % 2 == 0) {
+        digit[digits / 2] = static_cast<uint8_t>(length);
+      }
+      ++digits;
+    }
+    bytes = digits / 2;
+  }
+};
+
+// Plain, PostgreSQL, Cisco dotted and colon/hyphen notations. Separator
+// classes do not distinguish ':', '-' and '.', so "08-00-2b-01-02-03" and
+// "0800-2b01-0203" share the colon and dotted layouts.
+constexpr MacLayout kMacLayouts[] = {
+    MacLayout("xxxxxxxxxxxx"),
+    MacLayout("xxxxxx:xxxxxx"),
+    MacLayout("xxxx.xxxx.xxxx"),
+    MacLayout("xx:xx:xx:xx:xx:xx"),
+    MacLayout("xxxxxxxxxxxxxxxx"),
+    MacLayout("xxxx.xxxx.xxxx.xxxx"),
+    MacLayout("xx:xx:xx:xx:xx:xx:xx:xx"),
+};
+
+const MacLayout *find_mac_layout(size_t length, int bytes) {
+  for (const MacLayout &layout : kMacLayouts) {
+    if (layout.length == length && layout.bytes == bytes) {
+      return &layout;
+    }
+  }
+  return nullptr;
+}
+
+// Pack the nibbles of a validated layout into bytes
+void gather_mac_nibbles(const uint8_t *nibbles, const MacLayout &layout,
+                        uint8_t *address) {
+  for (int i = 0; i < layout.bytes; ++i) {
+    const uint8_t *pair = nibbles + layout.digit[i];
+    address[i] = static_cast<uint8_t>((pair[0] << 4) | pair[1]);
+  }
+}
+
+// Validate text against layout and decode its hex digits: every position is
+// classified and converted to a nibble, then the nibble pairs are gathered
+// from the layout's digit positions. False means text does not have this
+// exact layout.
+bool decode_mac_layout_scalar(const char *text, const MacLayout &layout,
+                              uint8_t *address) {
+  alignas(16) uint8_t chars[MacLayout::kWidth] = {};
+  alignas(16) uint8_t nibbles[MacLayout::kWidth];
+  memcpy(chars, text, layout.length);
+
+  for (size_t at = 0; at < layout.length; ++at) {
+    const uint8_t c = chars[at];
+    const uint8_t d = static_cast<uint8_t>(c - '0');
+    const uint8_t a = static_cast<uint8_t>((c | 0x20) - 'a');
+    uint8_t cls = 0;
+    if (d <= 9 || a <= 5) {
+      cls = 1;
+    } else if (c == ':' || c == '-' || c == '.') {
+      cls = 2;
+    }
+    if (cls != layout.cls[at]) {
+      return false;
+    }
+    nibbles[at] = d <= 9 ? d : static_cast<uint8_t>(a + 10);
+  }
+
+  gather_mac_nibbles(nibbles, layout, address);
+  return true;
+}
+
+#if defined(__SSE2__)
+// Same contract, classifying 16 characters at a time
+bool decode_mac_layout_sse2(const char *text, const MacLayout &layout,
+                            uint8_t *address) {
+  alignas(16) uint8_t chars[MacLayout::kWidth] = {};
+  alignas(16) uint8_t nibbles[MacLayout::kWidth];
+  memcpy(chars, text, layout.length);
+
+  for (size_t at = 0; at < layout.length; at += 16) {
+    const __m128i c =
+        _mm_load_si128(reinterpret_cast<const __m128i *>(chars + at));
+    // Unsigned x <= n as min(x, n) == x; SSE2 has no unsigned byte compare
+    const __m128i d = _mm_sub_epi8(c, _mm_set1_epi8('0'));
+    const __m128i is_digit =
+        _mm_cmpeq_epi8(_mm_min_epu8(d, _mm_set1_epi8(9)), d);
+    const __m128i a = _mm_sub_epi8(_mm_or_si128(c, _mm_set1_epi8(0x20)),
+                                   _mm_set1_epi8('a'));
+    const __m128i is_alpha =
+        _mm_cmpeq_epi8(_mm_min_epu8(a, _mm_set1_epi8(5)), a);
+    const __m128i is_sep =
+        _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(c, _mm_set1_epi8(':')),
+                                  _mm_cmpeq_epi8(c, _mm_set1_epi8('-'))),
+                     _mm_cmpeq_epi8(c, _mm_set1_epi8('.')));
+    const __m128i cls = _mm_or_si128(
+        _mm_and_si128(_mm_or_si128(is_digit, is_alpha), _mm_set1_epi8(1)),
+        _mm_and_si128(is_sep, _mm_set1_epi8(2)));
+    const __m128i expected =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(layout.cls + at));
+    if (_mm_movemask_epi8(_mm_cmpeq_epi8(cls, expected)) != 0xFFFF) {
+      return false;
+    }
+    const __m128i nibble =
+        _mm_or_si128(_mm_and_si128(is_digit, d),
+                     _mm_andnot_si128(is_digit,
+                                      _mm_add_epi8(a, _mm_set1_epi8(10))));
+    _mm_store_si128(reinterpret_cast<__m128i *>(nibbles + at), nibble);
+  }
+
+  gather_mac_nibbles(nibbles, layout, address);
+  return true;
+}
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+bool decode_mac_layout_neon(const char *text, const MacLayout &layout,
+                            uint8_t *address) {
+  alignas(16) uint8_t chars[MacLayout::kWidth] = {};
+  alignas(16) uint8_t nibbles[MacLayout::kWidth];
+  memcpy(chars, text, layout.length);
+
+  for (size_t at = 0; at < layout.length; at += 16) {
+    const uint8x16_t c = vld1q_u8(chars + at);
+    const uint8x16_t d = vsubq_u8(c, vdupq_n_u8('0'));
+    const uint8x16_t is_digit = vcleq_u8(d, vdupq_n_u8(9));
+    const uint8x16_t a =
+        vsubq_u8(vorrq_u8(c, vdupq_n_u8(0x20)), vdupq_n_u8('a'));
+    const uint8x16_t is_alpha = vcleq_u8(a, vdupq_n_u8(5));
+    const uint8x16_t is_sep =
+        vorrq_u8(vorrq_u8(vceqq_u8(c, vdupq_n_u8(':')),
+                          vceqq_u8(c, vdupq_n_u8('-'))),
+                 vceqq_u8(c, vdupq_n_u8('.')));
+    const uint8x16_t cls =
+        vorrq_u8(vandq_u8(vorrq_u8(is_digit, is_alpha), vdupq_n_u8(1)),
+                 vandq_u8(is_sep, vdupq_n_u8(2)));
+    if (vminvq_u8(vceqq_u8(cls, vld1q_u8(layout.cls + at))) != 0xFF) {
+      return false;
+    }
+    vst1q_u8(nibbles + at,
+             vbslq_u8(is_digit, d, vaddq_u8(a, vdupq_n_u8(10))));
+  }
+
+  gather_mac_nibbles(nibbles, layout, address);
+  return true;
+}
+#endif
+
+// ============================================================================
+// Kernel Dispatch
+// ============================================================================
+
+// One implementation of every vectorized kernel. The best set for the CPU
+// is picked once when the library loads and called through g_kernels; the
+// scalar set runs until then.
+struct KernelSet {
+  const char *name;
+  bool (*parse_ipv4_dotted)(const char *, size_t, uint32_t *);
+  bool (*decode_mac_layout)(const char *, const MacLayout &, uint8_t *);
+  void (*format_hex)(const uint8_t *, const HexLayout &, char *);
+};
+
+constexpr KernelSet kScalarKernels = {"scalar", parse_ipv4_dotted_scalar,
+                                      decode_mac_layout_scalar,
+                                      format_hex_scalar};
+#if defined(__SSE2__)
+constexpr KernelSet kSse2Kernels = {"sse2", parse_ipv4_dotted_scalar,
+                                    decode_mac_layout_sse2, format_hex_scalar};
+#endif
+#ifdef NETWORK_ADDRESS_X86_DISPATCH
+constexpr KernelSet kSsse3Kernels = {"ssse3", parse_ipv4_dotted_ssse3,
+                                     decode_mac_layout_sse2, format_hex_ssse3};
+#endif
+#if defined(__aarch64__) && defined(__ARM_NEON)
+constexpr KernelSet kNeonKernels = {"neon", parse_ipv4_dotted_scalar,
+                                    decode_mac_layout_neon, format_hex_neon};
+#endif
+
+const KernelSet *best_kernels(bool force_scalar) {
+  if (force_scalar) {
+    return &kScalarKernels;
+  }
+#ifdef NETWORK_ADDRESS_X86_DISPATCH
+  // May run from a static constructor, before libgcc has probed the CPU
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("ssse3")) {
+    return &kSsse3Kernels;
+  }
+#endif
+#if defined(__SSE2__)
+  return &kSse2Kernels;
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+  return &kNeonKernels;
+#else
+  return &kScalarKernels;
+#endif
+}
+
+// Set in the server's environment to anything but "0" to run the scalar
+// kernels, e.g. to rule the vector code in or out of a wrong result
+bool force_scalar_from_environment() {
+  const char *value = getenv("VSQL_NETWORK_ADDRESS_FORCE_SCALAR");
+  return value != nullptr && *value != '\0' && strcmp(value, "0") != 0;
+}
+
+std::atomic<const KernelSet *> g_kernels{&kScalarKernels};
+
+struct KernelResolver {
+  KernelResolver() {
+    g_kernels.store(best_kernels(force_scalar_from_environment()),
+                    std::memory_order_relaxed);
+  }
+} g_kernel_resolver;
+
+const KernelSet &kernels() {
+  return *g_kernels.load(std::memory_order_relaxed);
+}
+
+bool parse_ipv4_dotted(const char *text, size_t length, uint32_t *address) {
+  return kernels().parse_ipv4_dotted(text, length, address);
+}
+
+bool decode_mac_layout(const char *text, const MacLayout &layout,
+                       uint8_t *address) {
+  return kernels().decode_mac_layout(text, layout, address);
+}
+
+// Write the hex text of bytes into buffer, truncating like snprintf when
+// the buffer is too small.
+void format_hex(const uint8_t *bytes, const HexLayout &layout, char *buffer,
+                size_t buffer_size) {
+  char text[HexLayout::kChunks * 16];
+  char *out = buffer_size > layout.length ? buffer : text;
+  kernels().format_hex(bytes, layout, out);
+  if (out == text && buffer_size > 0) {
+    memcpy(buffer, text, buffer_size - 1);
+    buffer[buffer_size - 1] = '\0';
+  }
+}
+
+} // namespace
+
+const char *kernel_set() {
+  return kernels().name;
+}
+
+const char *select_kernels(bool force_scalar) {
+  g_kernels.store(best_kernels(force_scalar), std::memory_order_relaxed);
+  return kernel_set();
+}
+
+// Helper functions for parsing network addresses
+
+// Parse IPv4 address string "192.168.1.1" into uint32_t
+// The octets may carry leading zeros ("010" is ten), but otherwise the text
+// must be what inet_pton(AF_INET) accepts: no signs, spaces or trailing text.
+bool parse_ipv4_address(const char* addr_str, uint32_t* address) {
+  const size_t length = strnlen(addr_str, kMaxDottedQuad + 1);
+  return length <= kMaxDottedQuad &&
+         parse_ipv4_dotted(addr_str, length, address);
+}
+
+// Format IPv4 address from uint32_t to string
+void format_ipv4_address(uint32_t address, char* buffer, size_t buffer_size) {
+  snprintf(buffer, buffer_size, "%u.%u.%u.%u",
+           (address >> 24) & 0xFF,
+           (address >> 16) & 0xFF,
+           (address >> 8) & 0xFF,
+           address & 0xFF);
+}
+
+// Read one IPv6 group of one to four hex digits at text; returns the
+// character after it, or nullptr if there is no such group
+static const char *parse_ipv6_group(const char *text, uint16_t *group) {
+  uint32_t value = 0;
+  int digits = 0;
+  for (;; ++text, ++digits) {
+    const unsigned char ch = static_cast<unsigned char>(*text);
+    uint32_t nibble;
+    if (ch >= '0' && ch <= '9') {
+      nibble = ch - '0';
+    } else if ((ch | 0x20) >= 'a' && (ch | 0x20) <= 'f') {
+      nibble = (ch | 0x20) - 'a' + 10;
+    } else {
+      break;
+    }
+    if (digits == 4) {
+      return nullptr;
+    }
+    value = (value << 4) | nibble;
+  }
+  if (digits == 0) {
+    return nullptr;
+  }
+  *group = static_cast<uint16_t>(value);
+  return text;
+}
+
+// Parse IPv6 address string with :: compression support
+// Eight groups, or at most seven around a single "::", with nothing before,
+// between or after them: the hex forms inet_pton(AF_INET6) accepts. A
+// dotted IPv4 tail ("::ffff:192.0.2.1") is not supported.
+bool parse_ipv6_address(const char* addr_str, uint8_t* address) {
+  if (addr_str == nullptr || address == nullptr) {
+    return false;
+  }
+
+  uint16_t groups[8];
+  int count = 0;
+  int gap = -1;  // Number of groups before "::", if there is one
+  const char *p = addr_str;
+  if (p[0] == ':') {
+    if (p[1] != ':') {
+      return false;
+    }
+    gap = 0;
+    p += 2;
+  }
+  while (*p != '\0') {
+    if (count == 8) {
+      return false;
+    }
+    p = parse_ipv6_group(p, &groups[count++]);
+    if (p == nullptr) {
+      return false;
+    }
+    if (*p == '\0') {
+      break;
+    }
+    if (*p++ != ':') {
+      return false;
+    }
+    if (*p == ':') {
+      if (gap >= 0) {
+        return false;  // A second "::"
+      }
+      gap = count;
+      ++p;
+    } else if (*p == '\0') {
+      return false;  // Trailing single colon
+    }
+  }
+  if (gap < 0 ? count != 8 : count > 7) {
+    return false;
+  }
+
+  // Groups before the gap go first, the rest at the end, zeros between
+  memset(address, 0, 16);
+  const int before = gap < 0 ? count : gap;
+  for (int i = 0; i < count; i++) {
+    const int slot = i < before ? i : 8 - count + i;
+    address[slot * 2] = static_cast<uint8_t>(groups[i] >> 8);
+    address[slot * 2 + 1] = static_cast<uint8_t>(groups[i]);
+  }
+  return true;
+}
+
+// Format IPv6 address to string
+void format_ipv6_address(const uint8_t* address, char* buffer, size_t buffer_size) {
+  format_hex(address, kIPv6Hex, buffer, buffer_size);
+}
+
+// Parse MAC address string "08:00:2b:01:02:03"
+// Separators (':', '-', '.') may appear anywhere; exactly expected_bytes * 2
+// hex digits must be present. The usual notations are decoded through a
+// fixed layout; anything else takes the digit-by-digit loop below. Decodes
+// in place without allocating.
+bool parse_mac_address(const char* mac_str, uint8_t* address, int expected_bytes) {
+  if (mac_str == nullptr || address == nullptr) {
+    return false;
+  }
+
+  const MacLayout *layout = find_mac_layout(
+      strnlen(mac_str, MacLayout::kWidth + 1), expected_bytes);
+  if (layout != nullptr && decode_mac_layout(mac_str, *layout, address)) {
+    return true;
+  }
+
+  int digits = 0;
+  for (const char *cursor = mac_str; *cursor != '\0'; ++cursor) {
+    unsigned char ch = static_cast<unsigned char>(*cursor);
+    uint8_t nibble;
+    if (ch >= '0' && ch <= '9') {
+      nibble = ch - '0';
+    } else if (ch >= 'a' && ch <= 'f') {
+      nibble = ch - 'a' + 10;
+    } else if (ch >= 'A' && ch <= 'F') {
+      nibble = ch - 'A' + 10;
+    } else if (ch == ':' || ch == '-' || ch == '.') {
+      continue; // Accept common separators
+    } else {
+      return false; // Reject unexpected characters early
+    }
+
+    if (digits >= expected_bytes * 2) {
+      return false; // Too many hex digits
+    }
+    if (digits % 2 == 0) {
+      address[digits / 2] = static_cast<uint8_t>(nibble << 4);
+    } else {
+      address[digits / 2] |= nibble;
+    }
+    digits++;
+  }
+
+  return digits == expected_bytes * 2;
+}
+
+// Format MAC address to string
+void format_mac_address(const uint8_t* address, char* buffer, size_t buffer_size, int bytes) {
+  if (bytes == 6) {
+    format_hex(address, kMacHex, buffer, buffer_size);
+  } else if (bytes == 8) {
+    format_hex(address, kMac8Hex, buffer, buffer_size);
+  }
+}
+
+// Helper to get family from buffer
+// The IPv6 family byte is checked first: an IPv6 address whose sixth byte
+// happens to be 2 would otherwise be mistaken for an IPv4 value.
+static inline uint8_t get_address_family(const unsigned char *buffer,
+                                         size_t buffer_size) {
+  if (buffer == nullptr || buffer_size < sizeof(IPv4Network)) {
+    return 0;
+  }
+
+  // Try IPv6 first (family at offset 17)
+  if (buffer_size >= sizeof(IPv6Network) && buffer[17] == AF_INET6_VAL) {
+    return AF_INET6_VAL;
+  }
+
+  // Try IPv4 (family at offset 5)
+  if (buffer[5] == AF_INET_VAL) {
+    return AF_INET_VAL;
+  }
+
+  return 0; // Unknown
+}
+
+// ============================================================================
+// USDT Probes
+// ============================================================================
+//
+// Each public encode_*, decode_* and cmp_* function runs its body through
+// traced_encode, traced_decode or traced_compare. Without
+// NETWORK_ADDRESS_USDT these are plain calls the compiler inlines away.
+//
+//   encode__entry(type, text, text_len)
+//   encode__return(type, text_len, family, error)
+//   decode__entry(type, value_len)
+//   decode__return(type, value_len, family, text_len, error)
+//   compare__entry(type, len1, len2)
+//   compare__return(type, family, result)
+//
+// type is the SQL type name ("inet", "macaddr8", ...). family is
+// AF_INET_VAL or AF_INET6_VAL, read from the value for INET and CIDR and
+// fixed for INET4 and INET6; it is 0 for MAC addresses and for values that
+// failed. error is 1 when the function failed.
+
+namespace {
+
+struct ProbeType {
+  const char *name;
+  bool network;    // Family read from an INET/CIDR value
+  uint8_t family;  // Otherwise the type's fixed family
+};
+
+constexpr ProbeType kProbeCidr{"cidr", true, 0};
+constexpr ProbeType kProbeInet{"inet", true, 0};
+constexpr ProbeType kProbeMacAddr{"macaddr", false, 0};
+constexpr ProbeType kProbeMacAddr8{"macaddr8", false, 0};
+constexpr ProbeType kProbeInet4{"inet4", false, AF_INET_VAL};
+constexpr ProbeType kProbeInet6{"inet6", false, AF_INET6_VAL};
+
+#if NETWORK_ADDRESS_USDT
+inline uint8_t probe_family(const ProbeType &type,
+                            const unsigned char *value, size_t length) {
+  return type.network ? get_address_family(value, length) : type.family;
+}
+#endif
+
+template <typename Encode>
+inline bool traced_encode(const ProbeType &type, Encode encode,
+                          unsigned char *buffer, size_t buffer_size,
+                          const char *from, size_t from_len, size_t *length) {
+#if NETWORK_ADDRESS_USDT
+  NETADDR_PROBE(encode__entry, type.name, from, from_len);
+  bool error = encode(buffer, buffer_size, from, from_len, length);
+  NETADDR_PROBE(encode__return, type.name, from_len,
+                error ? 0 : probe_family(type, buffer, *length), error);
+  return error;
+#else
+  (void)type;
+  return encode(buffer, buffer_size, from, from_len, length);
+#endif
+}
+
+template <typename Decode>
+inline bool traced_decode(const ProbeType &type, Decode decode,
+                          const unsigned char *buffer, size_t buffer_size,
+                          char *to, size_t to_size, size_t *to_length) {
+#if NETWORK_ADDRESS_USDT
+  NETADDR_PROBE(decode__entry, type.name, buffer_size);
+  bool error = decode(buffer, buffer_size, to, to_size, to_length);
+  NETADDR_PROBE(decode__return, type.name, buffer_size,
+                error ? 0 : probe_family(type, buffer, buffer_size),
+                error ? 0 : *to_length, error);
+  return error;
+#else
+  (void)type;
+  return decode(buffer, buffer_size, to, to_size, to_length);
+#endif
+}
+
+template <typename Compare>
+inline int traced_compare(const ProbeType &type, Compare compare,
+                          const unsigned char *data1, size_t len1,
+                          const unsigned char *data2, size_t len2) {
+#if NETWORK_ADDRESS_USDT
+  NETADDR_PROBE(compare__entry, type.name, len1, len2);
+  int result = compare(data1, len1, data2, len2);
+  NETADDR_PROBE(compare__return, type.name, probe_family(type, data1, len1),
+                result);
+  return result;
+#else
+  (void)type;
+  return compare(data1, len1, data2, len2);
+#endif
+}
+
+} // namespace
+
+// Encoding/decoding functions for each type
+
+namespace {
+
+bool MarkInvalid(size_t *length) {
+  if (length != nullptr) {
+    *length = 0;
+  }
+  return true;
+}
+
+void record_reject(const char *type, RejectReason reason, const char *from,
+                   size_t from_len);
+
+// MarkInvalid for text that does not parse, counted against the calling
+// SQL function when statistics are compiled in and offered to the reject
+// sampler
+bool ParseFailed(size_t *length, const char *type, RejectReason reason,
+                 const char *from, size_t from_len) {
+  note_parse_failure();
+  record_reject(type, reason, from, from_len);
+  return MarkInvalid(length);
+}
+
+// Copy input into a null-terminated stack buffer; false if it does not fit.
+// Keeps the encoders allocation-free so they can run on every row of a
+// dirty feed.
+bool CopyInput(const char *from, size_t from_len, char *input,
+               size_t input_size) {
+  if (from == nullptr || from_len >= input_size) {
+    return false;
+  }
+  memcpy(input, from, from_len);
+  input[from_len] = '\0';
+  return true;
+}
+
+// Split "address/masklen" where masklen is one to three digits ending the
+// input. False (leaving *netmask alone) when there is no slash, when the
+// address part is empty or too long, and for signs, spaces or trailing text
+// around the masklen.
+bool SplitPrefix(const char *input, char *addr_str, size_t addr_size,
+                 int *netmask) {
+  const char *slash = strchr(input, '/');
+  if (slash == nullptr || slash == input ||
+      static_cast<size_t>(slash - input) >= addr_size) {
+    return false;
+  }
+  int value = 0;
+  const char *digit = slash + 1;
+  for (; *digit != '\0'; ++digit) {
+    if (digit - slash > 3 || static_cast<unsigned>(*digit - '0') > 9) {
+      return false;
+    }
+    value = value * 10 + (*digit - '0');
+  }
+  if (digit == slash + 1) {
+    return false;
+  }
+  memcpy(addr_str, input, slash - input);
+  addr_str[slash - input] = '\0';
+  *netmask = value;
+  return true;
+}
+
+} // namespace
+
+// Uncached; encode_cidr() goes through the parse cache
+static bool encode_cidr_text(unsigned char *buffer, size_t buffer_size, const char *from, size_t from_len, size_t *length) {
+  if (buffer_size < sizeof(IPv4Network) || nullptr == buffer) {
+    return true;
+  }
+
+  char input[kMaxInputString];
+  if (!CopyInput(from, from_len, input, sizeof(input))) {
+    return ParseFailed(length, "cidr", RejectReason::kTooLong, from,
+                       from_len);
+  }
+  char addr_str[64];
+  int netmask;
+
+  if (!SplitPrefix(input, addr_str, sizeof(addr_str), &netmask)) {
+    return ParseFailed(length, "cidr", RejectReason::kBadPrefix, from,
+                       from_len);
+  }
+
+  // Try IPv4 first; zeroed so the padding byte is stored as 0
+  IPv4Network net4;
+  memset(&net4, 0, sizeof(net4));
+  if (parse_ipv4_address(addr_str, &net4.address)) {
+    if (netmask < 0 || netmask > IPV4_MAX_PREFIXLEN) {
+      return ParseFailed(length, "cidr", RejectReason::kPrefixRange, from,
+                         from_len);
+    }
+
+    net4.netmask = static_cast<uint8_t>(netmask);
+    net4.family = AF_INET_VAL;
+    net4.flags = ADDR_FLAG_CIDR;
+
+    // CIDR requires strict network validation
+    if (!validate_cidr_network(net4.address, net4.netmask)) {
+      return ParseFailed(length, "cidr", RejectReason::kHostBits, from,
+                         from_len);
+    }
+
+    memcpy(buffer, &net4, sizeof(IPv4Network));
+    *length = sizeof(IPv4Network);
+    return false;
+  }
+
+  // Try IPv6
+  if (buffer_size < sizeof(IPv6Network)) {
+    return true;
+  }
+
+  IPv6Network net6;
+  if (parse_ipv6_address(addr_str, net6.address)) {
+    if (netmask < 0 || netmask > IPV6_MAX_PREFIXLEN) {
+      return ParseFailed(length, "cidr", RejectReason::kPrefixRange, from,
+                         from_len);
+    }
+
+    net6.netmask = static_cast<uint8_t>(netmask);
+    net6.family = AF_INET6_VAL;
+    net6.flags = ADDR_FLAG_CIDR;
+
+    // CIDR requires strict network validation
+    if (!validate_cidr_network_ipv6(net6.address, net6.netmask)) {
+      return ParseFailed(length, "cidr", RejectReason::kHostBits, from,
+                         from_len);
+    }
+
+    memcpy(buffer, &net6, sizeof(IPv6Network));
+    *length = sizeof(IPv6Network);
+    return false;
+  }
+
+  return ParseFailed(length, "cidr", RejectReason::kBadAddress, from,
+                     from_len);
+}
+
+// Uncached; decode_cidr() goes through the format cache
+static bool decode_cidr_text(const unsigned char *buffer, size_t buffer_size, char *to, size_t to_size, size_t *to_length) {
+  if (buffer_size < sizeof(IPv4Network) || nullptr == buffer || nullptr == to) {
+    return true;
+  }
+
+  // Check family to determine which structure to use
+  // For IPv4: family is at byte 5 (4 bytes address + 1 byte netmask)
+  // For IPv6: family is at byte 17 (16 bytes address + 1 byte netmask)
+  uint8_t family = get_address_family(buffer, buffer_size);
+
+  if (family == AF_INET_VAL && buffer_size >= sizeof(IPv4Network)) {
+    IPv4Network net;
+    memcpy(&net, buffer, sizeof(IPv4Network));
+
+    char addr_str[32];
+    format_ipv4_address(net.address, addr_str, sizeof(addr_str));
+
+    char result[64];
+    snprintf(result, sizeof(result), "%s/%u", addr_str,
+             (unsigned int)net.netmask);
+
+    size_t len = strlen(result);
+    if (len + 1 > to_size) return true;
+    strcpy(to, result);
+    *to_length = len;
+    return false;
+
+  } else if (buffer_size >= sizeof(IPv6Network)) {
+    // Check if it's IPv6
+    uint8_t ipv6_family = buffer[17]; // Family byte for IPv6
+    if (ipv6_family == AF_INET6_VAL) {
+      IPv6Network net;
+      memcpy(&net, buffer, sizeof(IPv6Network));
+
+      char addr_str[kMaxIPv6String];
+      format_ipv6_address(net.address, addr_str, sizeof(addr_str));
+
+      char result[kMaxIPv6String];
+      snprintf(result, sizeof(result), "%s/%u", addr_str,
+               (unsigned int)net.netmask);
+
+      size_t len = strlen(result);
+      if (len + 1 > to_size) return true;
+      strcpy(to, result);
+      *to_length = len;
+      return false;
+    }
+  }
+
+  return true; // Unknown family
+}
+
+// Uncached; encode_inet() goes through the parse cache
+static bool encode_inet_text(unsigned char *buffer, size_t buffer_size, const char *from, size_t from_len, size_t *length) {
+  if (buffer_size < sizeof(IPv4Network) || nullptr == buffer) {
+    return true;
+  }
+
+  char input[kMaxInputString];
+  if (!CopyInput(from, from_len, input, sizeof(input))) {
+    return ParseFailed(length, "inet", RejectReason::kTooLong, from,
+                       from_len);
+  }
+  char prefix_addr[64];
+  const char *addr_str = prefix_addr;
+  int netmask = -1; // Will be set based on address family
+
+  // "address/masklen", or the whole input as the address
+  if (!SplitPrefix(input, prefix_addr, sizeof(prefix_addr), &netmask)) {
+    if (strchr(input, '/') != nullptr) {
+      return ParseFailed(length, "inet", RejectReason::kBadPrefix, from,
+                         from_len);
+    }
+    addr_str = input;
+  }
+
+  // Try IPv4 first; zeroed so the padding byte is stored as 0
+  IPv4Network net4;
+  memset(&net4, 0, sizeof(net4));
+  if (parse_ipv4_address(addr_str, &net4.address)) {
+    if (netmask == -1) {
+      netmask = IPV4_MAX_PREFIXLEN; // Default for IPv4
+    }
+    if (netmask < 0 || netmask > IPV4_MAX_PREFIXLEN) {
+      return ParseFailed(length, "inet", RejectReason::kPrefixRange, from,
+                         from_len);
+    }
+
+    net4.netmask = static_cast<uint8_t>(netmask);
+    net4.family = AF_INET_VAL;
+    net4.flags = ADDR_FLAG_INET;
+
+    memcpy(buffer, &net4, sizeof(IPv4Network));
+    *length = sizeof(IPv4Network);
+    return false;
+  }
+
+  // Try IPv6
+  if (buffer_size < sizeof(IPv6Network)) {
+    return true;
+  }
+
+  IPv6Network net6;
+  if (parse_ipv6_address(addr_str, net6.address)) {
+    if (netmask == -1) {
+      netmask = IPV6_MAX_PREFIXLEN; // Default for IPv6
+    }
+    if (netmask < 0 || netmask > IPV6_MAX_PREFIXLEN) {
+      return ParseFailed(length, "inet", RejectReason::kPrefixRange, from,
+                         from_len);
+    }
+
+    net6.netmask = static_cast<uint8_t>(netmask);
+    net6.family = AF_INET6_VAL;
+    net6.flags = ADDR_FLAG_INET;
+
+    memcpy(buffer, &net6, sizeof(IPv6Network));
+    *length = sizeof(IPv6Network);
+    return false;
+  }
+
+  return ParseFailed(length, "inet", RejectReason::kBadAddress, from,
+                     from_len);
+}
+
+// Uncached; decode_inet() goes through the format cache
+static bool decode_inet_text(const unsigned char *buffer, size_t buffer_size, char *to, size_t to_size, size_t *to_length) {
+  if (buffer_size < sizeof(IPv4Network) || nullptr == buffer || nullptr == to) {
+    return true;
+  }
+
+  // Check family to determine which structure to use
+  uint8_t family = get_address_family(buffer, buffer_size);
+
+  if (family == AF_INET_VAL && buffer_size >= sizeof(IPv4Network)) {
+    IPv4Network net;
+    memcpy(&net, buffer, sizeof(IPv4Network));
+
+    char addr_str[32];
+    format_ipv4_address(net.address, addr_str, sizeof(addr_str));
+
+    char result[64];
+    if (net.netmask == IPV4_MAX_PREFIXLEN) {
+      // Don't show /32 for host addresses
+      snprintf(result, sizeof(result), "%s", addr_str);
+    } else {
+      snprintf(result, sizeof(result), "%s/%u", addr_str,
+               (unsigned int)net.netmask);
+    }
+
+    size_t len = strlen(result);
+    if (len + 1 > to_size) return true;
+    strcpy(to, result);
+    *to_length = len;
+    return false;
+
+  } else if (buffer_size >= sizeof(IPv6Network)) {
+    // Check if it's IPv6
+    uint8_t ipv6_family = buffer[17]; // Family byte for IPv6
+    if (ipv6_family == AF_INET6_VAL) {
+      IPv6Network net;
+      memcpy(&net, buffer, sizeof(IPv6Network));
+
+      char addr_str[kMaxIPv6String];
+      format_ipv6_address(net.address, addr_str, sizeof(addr_str));
+
+      char result[kMaxIPv6String];
+      if (net.netmask == IPV6_MAX_PREFIXLEN) {
+        // Don't show /128 for host addresses
+        snprintf(result, sizeof(result), "%s", addr_str);
+      } else {
+        snprintf(result, sizeof(result), "%s/%u", addr_str,
+                 (unsigned int)net.netmask);
+      }
+
+      size_t len = strlen(result);
+      if (len + 1 > to_size) return true;
+      strcpy(to, result);
+      *to_length = len;
+      return false;
+    }
+  }
+
+  return true; // Unknown family
+}
+
+// Uncached; encode_macaddr() goes through the parse cache
+static bool encode_macaddr_text(unsigned char *buffer, size_t buffer_size, const char *from, size_t from_len, size_t *length) {
+  if (buffer_size < sizeof(MacAddr) || nullptr == buffer) {
+    return true;
+  }
+
+  char input[kMaxInputString];
+  if (!CopyInput(from, from_len, input, sizeof(input))) {
+    return ParseFailed(length, "macaddr", RejectReason::kTooLong, from,
+                       from_len);
+  }
+  MacAddr mac;
+
+  if (!parse_mac_address(input, mac.address, 6)) {
+    return ParseFailed(length, "macaddr", RejectReason::kBadAddress, from,
+                       from_len);
+  }
+
+  memcpy(buffer, &mac, sizeof(MacAddr));
+  *length = sizeof(MacAddr);
+  return false;
+}
+
+// Uncached; decode_macaddr() goes through the format cache
+static bool decode_macaddr_text(const unsigned char *buffer, size_t buffer_size, char *to, size_t to_size, size_t *to_length) {
+  if (buffer_size < sizeof(MacAddr) || nullptr == buffer || nullptr == to) {
+    return true;
+  }
+
+  MacAddr mac;
+  memcpy(&mac, buffer, sizeof(MacAddr));
+
+  char result[kMaxMacAddrString + 1];
+  format_mac_address(mac.address, result, sizeof(result), 6);
+
+  size_t len = strlen(result);
+  if (len + 1 > to_size) return true;
+  strcpy(to, result);
+  *to_length = len;
+  return false;
+}
+
+static bool encode_macaddr8_text(unsigned char *buffer, size_t buffer_size, const char *from, size_t from_len, size_t *length) {
+  if (buffer_size < sizeof(MacAddr8) || nullptr == buffer) {
+    return true;
+  }
+
+  char input[kMaxInputString];
+  if (!CopyInput(from, from_len, input, sizeof(input))) {
+    return ParseFailed(length, "macaddr8", RejectReason::kTooLong, from,
+                       from_len);
+  }
+  MacAddr8 mac8;
+
+  if (!parse_mac_address(input, mac8.address, 8)) {
+    return ParseFailed(length, "macaddr8", RejectReason::kBadAddress, from,
+                       from_len);
+  }
+
+  memcpy(buffer, &mac8, sizeof(MacAddr8));
+  *length = sizeof(MacAddr8);
+  return false;
+}
+
+static bool decode_macaddr8_text(const unsigned char *buffer, size_t buffer_size, char *to, size_t to_size, size_t *to_length) {
+  if (buffer_size < sizeof(MacAddr8) || nullptr == buffer || nullptr == to) {
+    return true;
+  }
+
+  MacAddr8 mac8;
+  memcpy(&mac8, buffer, sizeof(MacAddr8));
+
+  char result[kMaxMacAddr8String + 1];
+  format_mac_address(mac8.address, result, sizeof(result), 8);
+
+  size_t len = strlen(result);
+  if (len + 1 > to_size) return true;
+  strcpy(to, result);
+  *to_length = len;
+  return false;
+}
+
+bool encode_macaddr8(unsigned char *buffer, size_t buffer_size, const char *from, size_t from_len, size_t *length) {
+  return traced_encode(kProbeMacAddr8, encode_macaddr8_text, buffer,
+                       buffer_size, from, from_len, length);
+}
+
+bool decode_macaddr8(const unsigned char *buffer, size_t buffer_size, char *to, size_t to_size, size_t *to_length) {
+  return traced_decode(kProbeMacAddr8, decode_macaddr8_text, buffer,
+                       buffer_size, to, to_size, to_length);
+}
+
+// ============================================================================
+// Parse and Format Caches
+// ============================================================================
+//
+// Log-style ingest sees the same few thousand addresses over and over. When
+// enabled, encode_inet/encode_cidr/encode_macaddr look the input text up in
+// a direct-mapped, per-thread table of earlier results before parsing. A hit
+// compares the full text, so collisions only cost a miss. Only successful
+// encodes are stored. Every thread owns its table, so there are no locks on
+// the lookup path; the registry below exists so counters can be summed.
+//
+// The format cache is the same idea in the other direction: decode_inet,
+// decode_cidr, decode_macaddr and inet_host keyed by the stored bytes, for
+// reports that group by a handful of addresses and print each group's key.
+
+namespace {
+
+enum class ParseKind : uint8_t { kNone, kInet, kCidr, kMacAddr };
+
+// 4096 entries of 80 bytes, allocated per thread on first use
+constexpr size_t kParseCacheEntries = 4096;
+constexpr size_t kParseCacheMaxInput = 48;  // longest INET text is 43
+
+struct ParseCacheEntry {
+  uint64_t hash;
+  ParseKind kind;
+  uint8_t input_length;
+  uint8_t result_length;
+  char input[kParseCacheMaxInput];
+  unsigned char result[sizeof(IPv6Network)];
+};
+
+enum ParseCacheCounter { kParseHits, kParseMisses, kParseEvictions,
+                         kParseCounters };
+
+// Counters written only by their owning thread and read by any
+template <size_t N>
+struct ThreadCounters {
+  std::atomic<uint64_t> value[N] = {};
+
+  void add(size_t counter) {
+    value[counter].store(value[counter].load(std::memory_order_relaxed) + 1,
+                         std::memory_order_relaxed);
+  }
+};
+
+// Per-thread instances of T (which has a ThreadCounters member named
+// counters) with totals over all threads, live or exited
+template <class T, size_t N>
+class ThreadLocalRegistry {
+ public:
+  T &local() {
+    thread_local Holder holder(this);
+    if (holder.instance == nullptr) {
+      holder.instance.reset(new T());
+      std::lock_guard<std::mutex> lock(mutex_);
+      live_.push_back(holder.instance.get());
+    }
+    return *holder.instance;
+  }
+
+  void totals(uint64_t *out) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (size_t i = 0; i < N; ++i) {
+      out[i] = retired_[i];
+      for (const T *instance : live_) {
+        out[i] += instance->counters.value[i].load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+ private:
+  struct Holder {
+    explicit Holder(ThreadLocalRegistry *registry_) : registry(registry_) {}
+    ~Holder() {
+      if (instance != nullptr) {
+        registry->retire(instance.get());
+      }
+    }
+    ThreadLocalRegistry *registry;
+    std::unique_ptr<T> instance;
+  };
+
+  void retire(const T *instance) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (size_t i = 0; i < N; ++i) {
+      retired_[i] +=
+          instance->counters.value[i].load(std::memory_order_relaxed);
+    }
+    live_.erase(std::find(live_.begin(), live_.end(), instance));
+  }
+
+  std::mutex mutex_;
+  std::vector<const T *> live_;
+  uint64_t retired_[N] = {};
+};
+
+struct ParseCache {
+  ParseCacheEntry entries[kParseCacheEntries] = {};
+  ThreadCounters<kParseCounters> counters;
+};
+
+std::atomic<bool> g_parse_cache_enabled{false};
+ThreadLocalRegistry<ParseCache, kParseCounters> g_parse_caches;
+
+// Hash a key a word at a time; short tails are read as overlapping words
+// so every load has a fixed size
+uint64_t hash_key(uint8_t tag, const void *key, size_t length) {
+  constexpr uint64_t kMultiplier = 0x9E3779B97F4A7C15ULL;
+  const char *text = static_cast<const char *>(key);
+  uint64_t hash = (static_cast<uint64_t>(tag) << 56 | length) * kMultiplier;
+  auto mix = [&hash](uint64_t word) {
+    hash = (hash ^ word) * kMultiplier;
+    hash ^= hash >> 32;
+  };
+  if (length >= 8) {
+    size_t at = 0;
+    for (; at + 8 < length; at += 8) {
+      uint64_t word;
+      memcpy(&word, text + at, 8);
+      mix(word);
+    }
+    uint64_t tail;
+    memcpy(&tail, text + length - 8, 8);
+    mix(tail);
+  } else if (length >= 4) {
+    uint32_t head, tail;
+    memcpy(&head, text, 4);
+    memcpy(&tail, text + length - 4, 4);
+    mix(static_cast<uint64_t>(head) << 32 | tail);
+  } else {
+    for (size_t at = 0; at < length; ++at) {
+      mix(static_cast<unsigned char>(text[at]));
+    }
+  }
+  return hash;
+}
+
+// Equality and copy of short byte strings with fixed-size, overlapping
+// loads and stores. A libc call per cache hit costs more than the lookup.
+bool same_bytes(const void *a_, const void *b_, size_t length) {
+  const char *a = static_cast<const char *>(a_);
+  const char *b = static_cast<const char *>(b_);
+  if (length < 4) {
+    for (size_t i = 0; i < length; ++i) {
+      if (a[i] != b[i]) return false;
+    }
+    return true;
+  }
+  if (length < 8) {
+    uint32_t a0, a1, b0, b1;
+    memcpy(&a0, a, 4);
+    memcpy(&b0, b, 4);
+    memcpy(&a1, a + length - 4, 4);
+    memcpy(&b1, b + length - 4, 4);
+    return ((a0 ^ b0) | (a1 ^ b1)) == 0;
+  }
+  uint64_t diff = 0;
+  uint64_t aw, bw;
+  for (size_t at = 0; at + 8 < length; at += 8) {
+    memcpy(&aw, a + at, 8);
+    memcpy(&bw, b + at, 8);
+    diff |= aw ^ bw;
+  }
+  memcpy(&aw, a + length - 8, 8);
+  memcpy(&bw, b + length - 8, 8);
+  return (diff | (aw ^ bw)) == 0;
+}
+
+void copy_bytes(void *to_, const void *from_, size_t length) {
+  char *to = static_cast<char *>(to_);
+  const char *from = static_cast<const char *>(from_);
+  if (length < 4) {
+    for (size_t i = 0; i < length; ++i) to[i] = from[i];
+  } else if (length < 8) {
+    uint32_t head, tail;
+    memcpy(&head, from, 4);
+    memcpy(&tail, from + length - 4, 4);
+    memcpy(to, &head, 4);
+    memcpy(to + length - 4, &tail, 4);
+  } else if (length < 16) {
+    uint64_t head, tail;
+    memcpy(&head, from, 8);
+    memcpy(&tail, from + length - 8, 8);
+    memcpy(to, &head, 8);
+    memcpy(to + length - 8, &tail, 8);
+  } else {
+    char chunk[16];
+    for (size_t at = 0; at + 16 < length; at += 16) {
+      memcpy(chunk, from + at, 16);
+      memcpy(to + at, chunk, 16);
+    }
+    memcpy(chunk, from + length - 16, 16);
+    memcpy(to + length - 16, chunk, 16);
+  }
+}
+
+bool encode_cached(ParseKind kind,
+                   bool (*encode)(unsigned char *, size_t, const char *,
+                                  size_t, size_t *),
+                   unsigned char *buffer, size_t buffer_size, const char *from,
+                   size_t from_len, size_t *length) {
+  if (!g_parse_cache_enabled.load(std::memory_order_relaxed) ||
+      from == nullptr || buffer == nullptr || from_len > kParseCacheMaxInput) {
+    return encode(buffer, buffer_size, from, from_len, length);
+  }
+
+  ParseCache &cache = g_parse_caches.local();
+  const uint64_t hash = hash_key(static_cast<uint8_t>(kind), from, from_len);
+  ParseCacheEntry &entry = cache.entries[hash % kParseCacheEntries];
+  if (entry.hash == hash && entry.kind == kind &&
+      entry.input_length == from_len &&
+      same_bytes(entry.input, from, from_len) &&
+      entry.result_length <= buffer_size) {
+    cache.counters.add(kParseHits);
+    copy_bytes(buffer, entry.result, entry.result_length);
+    *length = entry.result_length;
+    return false;
+  }
+
+  cache.counters.add(kParseMisses);
+  if (encode(buffer, buffer_size, from, from_len, length)) {
+    return true;
+  }
+  if (entry.kind != ParseKind::kNone) {
+    cache.counters.add(kParseEvictions);
+  }
+  entry.hash = hash;
+  entry.kind = kind;
+  entry.input_length = static_cast<uint8_t>(from_len);
+  entry.result_length = static_cast<uint8_t>(*length);
+  memcpy(entry.input, from, from_len);
+  memcpy(entry.result, buffer, *length);
+  return false;
+}
+
+enum class DecodeKind : uint8_t { kNone, kInet, kCidr, kHost, kMacAddr };
+
+// 512 sets of two 80-byte entries, for a working set of a few hundred
+// values. Two ways keep a pair of hot values that share a set from
+// evicting each other on every row, which direct mapping would not.
+constexpr size_t kFormatCacheSets = 512;
+
+struct FormatCacheEntry {
+  uint64_t hash;
+  DecodeKind kind;
+  uint8_t key_length;
+  uint8_t text_length;
+  unsigned char key[sizeof(IPv6Network)];
+  char text[kMaxIPv6String];  // NUL-terminated
+};
+
+struct FormatCache {
+  FormatCacheEntry entries[kFormatCacheSets][2] = {};
+  ThreadCounters<kParseCounters> counters;
+};
+
+std::atomic<bool> g_format_cache_enabled{false};
+ThreadLocalRegistry<FormatCache, kParseCounters> g_format_caches;
+
+bool decode_cached(DecodeKind kind,
+                   bool (*decode)(const unsigned char *, size_t, char *,
+                                  size_t, size_t *),
+                   const unsigned char *buffer, size_t buffer_size, char *to,
+                   size_t to_size, size_t *to_length) {
+  // The stored value is the whole key: formatting depends on nothing else
+  if (!g_format_cache_enabled.load(std::memory_order_relaxed) ||
+      buffer == nullptr || to == nullptr || buffer_size < sizeof(MacAddr) ||
+      buffer_size > sizeof(IPv6Network)) {
+    return decode(buffer, buffer_size, to, to_size, to_length);
+  }
+
+  FormatCache &cache = g_format_caches.local();
+  const uint64_t hash =
+      hash_key(static_cast<uint8_t>(kind), buffer, buffer_size);
+  FormatCacheEntry *set = cache.entries[hash % kFormatCacheSets];
+  for (size_t way = 0; way < 2; ++way) {
+    const FormatCacheEntry &entry = set[way];
+    if (entry.hash == hash && entry.kind == kind &&
+        entry.key_length == buffer_size &&
+        same_bytes(entry.key, buffer, buffer_size)) {
+      cache.counters.add(kParseHits);
+      if (entry.text_length + 1u > to_size) return true;
+      copy_bytes(to, entry.text, entry.text_length + 1u);
+      *to_length = entry.text_length;
+      return false;
+    }
+  }
+
+  cache.counters.add(kParseMisses);
+  if (decode(buffer, buffer_size, to, to_size, to_length)) {
+    return true;
+  }
+  if (*to_length >= sizeof(set[0].text)) {
+    return false;
+  }
+  // The newest entry goes in way 0; the older one is dropped
+  if (set[1].kind != DecodeKind::kNone) {
+    cache.counters.add(kParseEvictions);
+  }
+  set[1] = set[0];
+  FormatCacheEntry &entry = set[0];
+  entry.hash = hash;
+  entry.kind = kind;
+  entry.key_length = static_cast<uint8_t>(buffer_size);
+  entry.text_length = static_cast<uint8_t>(*to_length);
+  memcpy(entry.key, buffer, buffer_size);
+  memcpy(entry.text, to, *to_length + 1);
+  return false;
+}
+
+// Each type's text conversions through its cache; the public functions add
+// the probes, and INET4/INET6 reuse the INET pair without firing them twice
+bool encode_cidr_cached(unsigned char *buffer, size_t buffer_size,
+                        const char *from, size_t from_len, size_t *length) {
+  return encode_cached(ParseKind::kCidr, encode_cidr_text, buffer,
+                       buffer_size, from, from_len, length);
+}
+
+bool encode_inet_cached(unsigned char *buffer, size_t buffer_size,
+                        const char *from, size_t from_len, size_t *length) {
+  return encode_cached(ParseKind::kInet, encode_inet_text, buffer,
+                       buffer_size, from, from_len, length);
+}
+
+bool encode_macaddr_cached(unsigned char *buffer, size_t buffer_size,
+                           const char *from, size_t from_len, size_t *length) {
+  return encode_cached(ParseKind::kMacAddr, encode_macaddr_text, buffer,
+                       buffer_size, from, from_len, length);
+}
+
+bool decode_cidr_cached(const unsigned char *buffer, size_t buffer_size,
+                        char *to, size_t to_size, size_t *to_length) {
+  return decode_cached(DecodeKind::kCidr, decode_cidr_text, buffer,
+                       buffer_size, to, to_size, to_length);
+}
+
+bool decode_inet_cached(const unsigned char *buffer, size_t buffer_size,
+                        char *to, size_t to_size, size_t *to_length) {
+  return decode_cached(DecodeKind::kInet, decode_inet_text, buffer,
+                       buffer_size, to, to_size, to_length);
+}
+
+bool decode_macaddr_cached(const unsigned char *buffer, size_t buffer_size,
+                           char *to, size_t to_size, size_t *to_length) {
+  return decode_cached(DecodeKind::kMacAddr, decode_macaddr_text, buffer,
+                       buffer_size, to, to_size, to_length);
+}
+
+} // namespace
+
+bool encode_cidr(unsigned char *buffer, size_t buffer_size, const char *from, size_t from_len, size_t *length) {
+  return traced_encode(kProbeCidr, encode_cidr_cached, buffer,
+                       buffer_size, from, from_len, length);
+}
+
+bool encode_inet(unsigned char *buffer, size_t buffer_size, const char *from, size_t from_len, size_t *length) {
+  return traced_encode(kProbeInet, encode_inet_cached, buffer,
+                       buffer_size, from, from_len, length);
+}
+
+bool encode_macaddr(unsigned char *buffer, size_t buffer_size, const char *from, size_t from_len, size_t *length) {
+  return traced_encode(kProbeMacAddr, encode_macaddr_cached, buffer,
+                       buffer_size, from, from_len, length);
+}
+
+bool set_parse_cache_enabled(bool enabled) {
+  return g_parse_cache_enabled.exchange(enabled, std::memory_order_relaxed);
+}
+
+bool parse_cache_enabled() {
+  return g_parse_cache_enabled.load(std::memory_order_relaxed);
+}
+
+CacheStats parse_cache_stats() {
+  uint64_t totals[kParseCounters];
+  g_parse_caches.totals(totals);
+  return CacheStats{totals[kParseHits], totals[kParseMisses],
+                    totals[kParseEvictions]};
+}
+
+bool decode_cidr(const unsigned char *buffer, size_t buffer_size, char *to, size_t to_size, size_t *to_length) {
+  return traced_decode(kProbeCidr, decode_cidr_cached, buffer,
+                       buffer_size, to, to_size, to_length);
+}
+
+bool decode_inet(const unsigned char *buffer, size_t buffer_size, char *to, size_t to_size, size_t *to_length) {
+  return traced_decode(kProbeInet, decode_inet_cached, buffer,
+                       buffer_size, to, to_size, to_length);
+}
+
+bool decode_macaddr(const unsigned char *buffer, size_t buffer_size, char *to, size_t to_size, size_t *to_length) {
+  return traced_decode(kProbeMacAddr, decode_macaddr_cached, buffer,
+                       buffer_size, to, to_size, to_length);
+}
+
+bool set_format_cache_enabled(bool enabled) {
+  return g_format_cache_enabled.exchange(enabled, std::memory_order_relaxed);
+}
+
+bool format_cache_enabled() {
+  return g_format_cache_enabled.load(std::memory_order_relaxed);
+}
+
+CacheStats format_cache_stats() {
+  uint64_t totals[kParseCounters];
+  g_format_caches.totals(totals);
+  return CacheStats{totals[kParseHits], totals[kParseMisses],
+                    totals[kParseEvictions]};
+}
+
+// ============================================================================
+// Function Statistics
+// ============================================================================
+//
+// Each thread counts into its own StatThread, registered in the same kind
+// of registry as the caches, so calls never share a cache line or take a
+// lock; readers sum the slots of every thread. Reset keeps a baseline to
+// subtract instead of zeroing counters that other threads are writing.
+
+namespace {
+
+#if NETWORK_ADDRESS_STATS
+std::mutex g_stat_mutex;  // registration, reset and reads
+const char *g_stat_names[kMaxStatFunctions];
+size_t g_stat_functions = 0;
+uint64_t g_stat_baseline[kStatCounters] = {};
+
+
+int64_t now_ns() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+#endif
+
+bool append_format(char *to, size_t to_size, size_t *pos, const char *format,
+                   ...) __attribute__((format(printf, 4, 5)));
+
+bool append_format(char *to, size_t to_size, size_t *pos, const char *format,
+                   ...) {
+  va_list args;
+  va_start(args, format);
+  int n = vsnprintf(to + *pos, to_size - *pos, format, args);
+  va_end(args);
+  if (n < 0 || static_cast<size_t>(n) >= to_size - *pos) {
+    return true;  // Error: result buffer too small
+  }
+  *pos += n;
+  return false;
+}
+
+} // namespace
+
+#if NETWORK_ADDRESS_STATS
+namespace {
+ThreadLocalRegistry<StatThread, kStatCounters> g_stat_threads;
+} // namespace
+
+StatThread *register_stat_thread() {
+  return t_stat_thread = &g_stat_threads.local();
+}
+
+int register_stat_function(const char *name) {
+  std::lock_guard<std::mutex> lock(g_stat_mutex);
+  for (size_t i = 0; i < g_stat_functions; ++i) {
+    if (strcmp(g_stat_names[i], name) == 0) return static_cast<int>(i);
+  }
+  if (g_stat_functions == kMaxStatFunctions) return -1;
+  g_stat_names[g_stat_functions] = name;
+  return static_cast<int>(g_stat_functions++);
+}
+
+void StatScope::start_sample() {
+  thread_->countdown = kLatencySamplePeriod;
+  start_ns_ = now_ns();
+}
+
+void StatScope::finish_sample() {
+  const uint64_t elapsed = static_cast<uint64_t>(now_ns() - start_ns_);
+  size_t bucket = elapsed < 2 ? 0 : 63 - __builtin_clzll(elapsed);
+  if (bucket >= kLatencyBuckets) bucket = kLatencyBuckets - 1;
+  thread_->counters.add(base_ + kStatLatency + bucket);
+}
+#endif
+
+bool stats_json(char *to, size_t to_size, size_t *to_length) {
+  if (to == nullptr || to_size == 0 || to_length == nullptr) {
+    return true;
+  }
+  size_t pos = 0;
+  if (append_format(to, to_size, &pos,
+                    "{\"instrumented\": %s, \"kernels\": \"%s\", "
+                    "\"sample_period\": %u, \"functions\": {",
+                    NETWORK_ADDRESS_STATS ? "true" : "false", kernel_set(),
+                    kLatencySamplePeriod)) {
+    return true;
+  }
+#if NETWORK_ADDRESS_STATS
+  std::vector<uint64_t> totals(kStatCounters);
+  g_stat_threads.totals(totals.data());
+  std::lock_guard<std::mutex> lock(g_stat_mutex);
+  bool first = true;
+  for (size_t f = 0; f < g_stat_functions; ++f) {
+    const uint64_t *total = &totals[f * kStatFields];
+    const uint64_t *baseline = &g_stat_baseline[f * kStatFields];
+    const uint64_t calls = total[kStatCalls] - baseline[kStatCalls];
+    if (calls == 0) continue;
+    uint64_t samples = 0;
+    for (size_t b = 0; b < kLatencyBuckets; ++b) {
+      samples += total[kStatLatency + b] - baseline[kStatLatency + b];
+    }
+    if (append_format(to, to_size, &pos,
+                      "%s\"%s\": {\"calls\": %llu, \"nulls\": %llu, "
+                      "\"parse_failures\": %llu, \"latency_ns\": "
+                      "{\"samples\": %llu, \"buckets\": {",
+                      first ? "" : ", ", g_stat_names[f],
+                      (unsigned long long)calls,
+                      (unsigned long long)(total[kStatNulls] -
+                                           baseline[kStatNulls]),
+                      (unsigned long long)(total[kStatParseFailures] -
+                                           baseline[kStatParseFailures]),
+                      (unsigned long long)samples)) {
+      return true;
+    }
+    first = false;
+    // Keyed by the bucket's exclusive upper bound in ns
+    bool first_bucket = true;
+    for (size_t b = 0; b < kLatencyBuckets; ++b) {
+      const uint64_t count =
+          total[kStatLatency + b] - baseline[kStatLatency + b];
+      if (count == 0) continue;
+      char bound[24];
+      if (b + 1 == kLatencyBuckets) {
+        snprintf(bound, sizeof(bound), "inf");
+      } else {
+        snprintf(bound, sizeof(bound), "%llu", 2ULL << b);
+      }
+      if (append_format(to, to_size, &pos, "%s\"%s\": %llu",
+                        first_bucket ? "" : ", ", bound,
+                        (unsigned long long)count)) {
+        return true;
+      }
+      first_bucket = false;
+    }
+    if (append_format(to, to_size, &pos, "}}}")) {
+      return true;
+    }
+  }
+#endif
+  if (append_format(to, to_size, &pos, "}}")) {
+    return true;
+  }
+  *to_length = pos;
+  return false;
+}
+
+void reset_stats() {
+#if NETWORK_ADDRESS_STATS
+  std::vector<uint64_t> totals(kStatCounters);
+  g_stat_threads.totals(totals.data());
+  std::lock_guard<std::mutex> lock(g_stat_mutex);
+  std::copy(totals.begin(), totals.end(), g_stat_baseline);
+#endif
+}
+
+// ============================================================================
+// Reject Sampling
+// ============================================================================
+
+namespace {
+
+// A slot's seq is 0 while empty, odd while a writer fills it and 2 * (n + 1)
+// once it holds rejection n. The fields are relaxed atomics so that a reader
+// racing a writer gets a torn copy, which the seq check discards, instead of
+// a data race.
+struct RejectSlot {
+  std::atomic<uint64_t> seq;
+  std::atomic<const char *> type;
+  std::atomic<uint8_t> reason;
+  std::atomic<uint32_t> length;  // of the whole input, not just the copy
+  std::atomic<uint64_t> text[kRejectTextBytes / 8];
+};
+
+RejectSlot g_reject_ring[kRejectRingSize];
+std::atomic<uint64_t> g_rejects_recorded{0};
+std::atomic<uint32_t> g_reject_sample_period{kDefaultRejectSamplePeriod};
+thread_local uint32_t t_reject_countdown = 0;  // 0: record the next one
+
+void record_reject(const char *type, RejectReason reason, const char *from,
+                   size_t from_len) {
+  const uint32_t period =
+      g_reject_sample_period.load(std::memory_order_relaxed);
+  if (period == 0 || from == nullptr) return;
+  // A countdown left over from a longer period is cut short
+  uint32_t &countdown = t_reject_countdown;
+  if (countdown != 0 && countdown < period) {
+    --countdown;
+    return;
+  }
+  countdown = period - 1;
+
+  const uint64_t n = g_rejects_recorded.fetch_add(1, std::memory_order_relaxed);
+  RejectSlot &slot = g_reject_ring[n % kRejectRingSize];
+  uint64_t seq = slot.seq.load(std::memory_order_relaxed);
+  if ((seq & 1) != 0 ||
+      !slot.seq.compare_exchange_strong(seq, 2 * n + 1,
+                                        std::memory_order_relaxed)) {
+    return;  // Another writer holds the slot; drop the sample
+  }
+  std::atomic_thread_fence(std::memory_order_release);
+
+  uint64_t words[kRejectTextBytes / 8] = {};
+  memcpy(words, from, std::min(from_len, kRejectTextBytes));
+  slot.type.store(type, std::memory_order_relaxed);
+  slot.reason.store(static_cast<uint8_t>(reason), std::memory_order_relaxed);
+  slot.length.store(static_cast<uint32_t>(from_len),
+                    std::memory_order_relaxed);
+  for (size_t i = 0; i < kRejectTextBytes / 8; ++i) {
+    slot.text[i].store(words[i], std::memory_order_relaxed);
+  }
+  slot.seq.store(2 * n + 2, std::memory_order_release);
+}
+
+// text as the body of a JSON string; bytes outside printable ASCII are
+// written as \u00XX
+bool append_json_text(char *to, size_t to_size, size_t *pos, const char *text,
+                      size_t text_len) {
+  for (size_t i = 0; i < text_len; ++i) {
+    const unsigned char c = static_cast<unsigned char>(text[i]);
+    bool error;
+    if (c == '"' || c == '\\') {
+      error = append_format(to, to_size, pos, "\\%c", c);
+    } else if (c < 0x20 || c >= 0x7F) {
+      error = append_format(to, to_size, pos, "\\u%04x", c);
+    } else {
+      error = append_format(to, to_size, pos, "%c", c);
+    }
+    if (error) return true;
+  }
+  return false;
+}
+
+} // namespace
+
+const char *reject_reason_name(RejectReason reason) {
+  switch (reason) {
+    case RejectReason::kTooLong:
+      return "too_long";
+    case RejectReason::kBadAddress:
+      return "bad_address";
+    case RejectReason::kBadPrefix:
+      return "bad_prefix";
+    case RejectReason::kPrefixRange:
+      return "prefix_range";
+    case RejectReason::kHostBits:
+      return "host_bits";
+    case RejectReason::kWrongFamily:
+      return "wrong_family";
+  }
+  return "unknown";
+}
+
+uint32_t set_reject_sample_period(uint32_t period) {
+  return g_reject_sample_period.exchange(period, std::memory_order_relaxed);
+}
+
+uint32_t reject_sample_period() {
+  return g_reject_sample_period.load(std::memory_order_relaxed);
+}
+
+bool recent_rejects_json(char *to, size_t to_size, size_t *to_length) {
+  if (to == nullptr || to_size == 0 || to_length == nullptr) {
+    return true;
+  }
+  const uint64_t recorded = g_rejects_recorded.load(std::memory_order_relaxed);
+  size_t pos = 0;
+  if (append_format(to, to_size, &pos,
+                    "{\"sample_period\": %u, \"recorded\": %llu, "
+                    "\"rejects\": [",
+                    reject_sample_period(),
+                    (unsigned long long)recorded)) {
+    return true;
+  }
+  bool first = true;
+  const uint64_t oldest =
+      recorded > kRejectRingSize ? recorded - kRejectRingSize : 0;
+  for (uint64_t n = recorded; n-- > oldest;) {
+    const RejectSlot &slot = g_reject_ring[n % kRejectRingSize];
+    if (slot.seq.load(std::memory_order_acquire) != 2 * n + 2) {
+      continue;  // Dropped, still being written, or already overwritten
+    }
+    const char *type = slot.type.load(std::memory_order_relaxed);
+    const auto reason =
+        static_cast<RejectReason>(slot.reason.load(std::memory_order_relaxed));
+    const uint32_t length = slot.length.load(std::memory_order_relaxed);
+    uint64_t words[kRejectTextBytes / 8];
+    for (size_t i = 0; i < kRejectTextBytes / 8; ++i) {
+      words[i] = slot.text[i].load(std::memory_order_relaxed);
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.seq.load(std::memory_order_relaxed) != 2 * n + 2) {
+      continue;  // Overwritten while copying
+    }
+
+    if (append_format(to, to_size, &pos,
+                      "%s{\"seq\": %llu, \"type\": \"%s\", \"reason\": "
+                      "\"%s\", \"length\": %u, \"text\": \"",
+                      first ? "" : ", ", (unsigned long long)n, type,
+                      reject_reason_name(reason), length) ||
+        append_json_text(to, to_size, &pos,
+                         reinterpret_cast<const char *>(words),
+                         std::min<size_t>(length, kRejectTextBytes)) ||
+        append_format(to, to_size, &pos, "\"}")) {
+      return true;
+    }
+    first = false;
+  }
+  if (append_format(to, to_size, &pos, "]}")) {
+    return true;
+  }
+  *to_length = pos;
+  return false;
+}
+
+// ============================================================================
+// Address Family Traits
+// ============================================================================
+//
+// The INET/CIDR operations below are written once, as templates over one of
+// these traits, rather than as a copy-pasted IPv4 and IPv6 branch. A trait
+// holds a whole address in one integer (uint32_t for IPv4, unsigned __int128
+// for IPv6), so masking is a single AND/OR instead of a byte loop. Each
+// public function tests the family once and then runs code specialized for
+// it.
+
+using uint128_t = unsigned __int128;
+
+// Load 8 bytes as a big-endian integer (a single load + bswap)
+static inline uint64_t load_be64(const uint8_t *p) {
+  uint64_t value;
+  memcpy(&value, p, sizeof(value));
+  return __builtin_bswap64(value);
+}
+
+// Store a 64-bit integer as 8 big-endian bytes
+static inline void store_be64(uint64_t value, uint8_t *p) {
+  value = __builtin_bswap64(value);
+  memcpy(p, &value, sizeof(value));
+}
+
+// Load 16 bytes as a big-endian 128-bit integer
+static inline uint128_t load_be128(const uint8_t *p) {
+  return (static_cast<uint128_t>(load_be64(p)) << 64) | load_be64(p + 8);
+}
+
+// Store a 128-bit integer as 16 big-endian bytes
+static inline void store_be128(uint128_t value, uint8_t *p) {
+  store_be64(static_cast<uint64_t>(value >> 64), p);
+  store_be64(static_cast<uint64_t>(value), p + 8);
+}
+
+// Netmask of every prefix length from 0 to kBits, computed at compile time
+// so that a mask is a single indexed load
+template <class Word, int kBits>
+struct NetmaskTable {
+  Word mask[kBits + 1];
+
+  constexpr NetmaskTable() : mask() {
+    for (int i = 1; i <= kBits; i++) {
+      mask[i] = static_cast<Word>(~Word(0) << (kBits - i));
+    }
+  }
+};
+
+struct IPv4Family {
+  using Word = uint32_t;
+  using Network = IPv4Network;
+  static constexpr uint8_t kFamily = AF_INET_VAL;
+  static constexpr int kMaxPrefixLen = IPV4_MAX_PREFIXLEN;
+  static constexpr size_t kMaxString = kMaxIPv4String + 1;
+  // Whether the last address of a network is reserved (IPv4 broadcast)
+  static constexpr bool kHasBroadcast = true;
+  static constexpr NetmaskTable<Word, IPV4_MAX_PREFIXLEN> kNetmasks{};
+
+  static Word address(const Network &net) { return net.address; }
+  static void set_address(Network *net, Word address) {
+    net->address = address;
+  }
+
+  // Leading zero bits (kMaxPrefixLen for zero)
+  static int clz(Word value) {
+    return value == 0 ? kMaxPrefixLen : __builtin_clz(value);
+  }
+
+  // Trailing zero bits (kMaxPrefixLen for zero)
+  static int ctz(Word value) {
+    return value == 0 ? kMaxPrefixLen : __builtin_ctz(value);
+  }
+
+  static void format(Word address, char *buffer, size_t buffer_size) {
+    format_ipv4_address(address, buffer, buffer_size);
+  }
+};
+
+struct IPv6Family {
+  using Word = uint128_t;
+  using Network = IPv6Network;
+  static constexpr uint8_t kFamily = AF_INET6_VAL;
+  static constexpr int kMaxPrefixLen = IPV6_MAX_PREFIXLEN;
+  static constexpr size_t kMaxString = kMaxIPv6String;
+  static constexpr bool kHasBroadcast = false;
+  static constexpr NetmaskTable<Word, IPV6_MAX_PREFIXLEN> kNetmasks{};
+
+  static Word address(const Network &net) { return load_be128(net.address); }
+  static void set_address(Network *net, Word address) {
+    store_be128(address, net->address);
+  }
+
+  static int clz(Word value) {
+    uint64_t hi = static_cast<uint64_t>(value >> 64);
+    if (hi != 0) {
+      return __builtin_clzll(hi);
+    }
+    uint64_t lo = static_cast<uint64_t>(value);
+    return lo == 0 ? kMaxPrefixLen : 64 + __builtin_clzll(lo);
+  }
+
+  static int ctz(Word value) {
+    uint64_t lo = static_cast<uint64_t>(value);
+    if (lo != 0) {
+      return __builtin_ctzll(lo);
+    }
+    uint64_t hi = static_cast<uint64_t>(value >> 64);
+    return hi == 0 ? kMaxPrefixLen : 64 + __builtin_ctzll(hi);
+  }
+
+  static void format(Word address, char *buffer, size_t buffer_size) {
+    uint8_t bytes[16];
+    store_be128(address, bytes);
+    format_ipv6_address(bytes, buffer, buffer_size);
+  }
+};
+
+// Netmask for a prefix length; lengths past kMaxPrefixLen (only seen in a
+// corrupt stored value) clamp to a full-length mask
+template <class Family>
+static constexpr typename Family::Word netmask_of(int prefix_len) {
+  return Family::kNetmasks.mask[static_cast<unsigned>(prefix_len) <=
+                                        Family::kMaxPrefixLen
+                                    ? prefix_len
+                                    : Family::kMaxPrefixLen];
+}
+
+// Hostmask for a prefix length (inverse of netmask)
+template <class Family>
+static constexpr typename Family::Word hostmask_of(int prefix_len) {
+  return static_cast<typename Family::Word>(~netmask_of<Family>(prefix_len));
+}
+
+template <class Family>
+static inline typename Family::Network load_network(const unsigned char *buffer) {
+  typename Family::Network net;
+  memcpy(&net, buffer, sizeof(net));
+  return net;
+}
+
+// Write an address and masklen to the result buffer as a stored value
+template <class Family>
+static inline bool store_network(typename Family::Word address, int masklen,
+                                 uint8_t flags, unsigned char *result_buffer,
+                                 size_t *result_length) {
+  typename Family::Network result{};
+  Family::set_address(&result, address);
+  result.netmask = static_cast<uint8_t>(masklen);
+  result.family = Family::kFamily;
+  result.flags = flags;
+
+  memcpy(result_buffer, &result, sizeof(result));
+  *result_length = sizeof(result);
+  return false;  // Success
+}
+
+// Format an address, with "/masklen" appended when masklen >= 0
+template <class Family>
+static size_t format_address(typename Family::Word address, int masklen,
+                             char *buffer, size_t buffer_size) {
+  Family::format(address, buffer, buffer_size);
+  size_t len = strlen(buffer);
+  if (masklen >= 0) {
+    len += snprintf(buffer + len, buffer_size - len, "/%d", masklen);
+  }
+  return len;
+}
+
+// Format an address as for format_address() into a caller's result buffer
+template <class Family>
+static inline bool store_text(typename Family::Word address, int masklen,
+                              char *result, size_t result_size,
+                              size_t *result_length) {
+  char text[Family::kMaxString];
+  size_t len = format_address<Family>(address, masklen, text, sizeof(text));
+  if (len + 1 > result_size) return true;
+  memcpy(result, text, len + 1);
+  *result_length = len;
+  return false;  // Success
+}
+
+// Call op with the trait of the buffer's family, or return error for an
+// unknown family
+template <class Result, class Op>
+static inline Result with_family(const unsigned char *buffer,
+                                 size_t buffer_size, Result error, Op op) {
+  switch (get_address_family(buffer, buffer_size)) {
+    case AF_INET_VAL:
+      return op(IPv4Family());
+    case AF_INET6_VAL:
+      return op(IPv6Family());
+    default:
+      return error;
+  }
+}
+
+// Comparison functions for each type
+
+// Three-way compare of two IPv4 values: the address, then the masklen,
+// packed into one 40-bit key per side
+static inline int cmp_ipv4_fused(uint32_t address1, uint8_t masklen1,
+                                 uint32_t address2, uint8_t masklen2) {
+  uint64_t key1 = (static_cast<uint64_t>(address1) << 8) | masklen1;
+  uint64_t key2 = (static_cast<uint64_t>(address2) << 8) | masklen2;
+  return (key1 > key2) - (key1 < key2);
+}
+
+// Three-way compare of two IPv6 values stored as a 16-byte big-endian
+// address followed by the masklen byte (the INET/CIDR layout, and INET6's).
+// The address is read in place as two 64-bit words and the words and the
+// masklen are compared in one pass without branching; the weights let the
+// first difference decide the sign.
+static inline int cmp_ipv6_fused(const unsigned char *data1,
+                                 const unsigned char *data2) {
+  uint64_t hi1 = load_be64(data1), hi2 = load_be64(data2);
+  uint64_t lo1 = load_be64(data1 + 8), lo2 = load_be64(data2 + 8);
+  int order = 4 * ((hi1 > hi2) - (hi1 < hi2)) +
+              2 * ((lo1 > lo2) - (lo1 < lo2)) +
+              ((data1[16] > data2[16]) - (data1[16] < data2[16]));
+  return (order > 0) - (order < 0);
+}
+
+// INET and CIDR share the internal structure and the ordering
+static int compare_network(const unsigned char *data1, size_t len1, const unsigned char *data2, size_t len2) {
+  // Both CIDR values should be the same size (IPv4Network or IPv6Network)
+  if (len1 != len2) {
+    // Different sizes mean different address families
+    // IPv4 (7 bytes) sorts before IPv6 (19 bytes) per PostgreSQL spec
+    return (len1 < len2) ? -1 : 1;
+  }
+
+  if (len1 == sizeof(IPv6Network)) {
+    return cmp_ipv6_fused(data1, data2);
+  } else if (len1 == sizeof(IPv4Network)) {
+    uint32_t address1, address2;
+    memcpy(&address1, data1, sizeof(address1));
+    memcpy(&address2, data2, sizeof(address2));
+    return cmp_ipv4_fused(address1, data1[4], address2, data2[4]);
+  }
+
+  // Fallback to binary comparison
+  int result = memcmp(data1, data2, len1);
+  if (result == 0) return 0;
+  return (result < 0) ? -1 : 1;
+}
+
+int cmp_cidr(const unsigned char *data1, size_t len1, const unsigned char *data2, size_t len2) {
+  return traced_compare(kProbeCidr, compare_network, data1, len1, data2, len2);
+}
+
+int cmp_inet(const unsigned char *data1, size_t len1, const unsigned char *data2, size_t len2) {
+  return traced_compare(kProbeInet, compare_network, data1, len1, data2, len2);
+}
+
+// Load the six octets of a MACADDR as a big-endian 48-bit integer
+static inline uint64_t load_be48(const uint8_t *p) {
+  uint32_t hi;
+  uint16_t lo;
+  memcpy(&hi, p, sizeof(hi));
+  memcpy(&lo, p + 4, sizeof(lo));
+  return (static_cast<uint64_t>(__builtin_bswap32(hi)) << 16) |
+         __builtin_bswap16(lo);
+}
+
+// MAC addresses order by their octets, which is the order of their packed
+// big-endian integers
+static int compare_macaddr(const unsigned char *data1, size_t len1, const unsigned char *data2, size_t len2) {
+  (void)len1;  // Used in assert, suppress warning
+  (void)len2;  // Used in assert, suppress warning
+  assert(sizeof(MacAddr) == len1);
+  assert(len1 == len2);
+
+  uint64_t mac1 = load_be48(data1), mac2 = load_be48(data2);
+  return (mac1 > mac2) - (mac1 < mac2);
+}
+
+static int compare_macaddr8(const unsigned char *data1, size_t len1, const unsigned char *data2, size_t len2) {
+  (void)len1;  // Used in assert, suppress warning
+  (void)len2;  // Used in assert, suppress warning
+  assert(sizeof(MacAddr8) == len1);
+  assert(len1 == len2);
+
+  uint64_t mac1 = load_be64(data1), mac2 = load_be64(data2);
+  return (mac1 > mac2) - (mac1 < mac2);
+}
+
+int cmp_macaddr(const unsigned char *data1, size_t len1, const unsigned char *data2, size_t len2) {
+  return traced_compare(kProbeMacAddr, compare_macaddr, data1, len1, data2,
+                        len2);
+}
+
+int cmp_macaddr8(const unsigned char *data1, size_t len1, const unsigned char *data2, size_t len2) {
+  return traced_compare(kProbeMacAddr8, compare_macaddr8, data1, len1, data2,
+                        len2);
+}
+
+// ============================================================================
+// Helper functions for mask calculations
+// ============================================================================
+
+// Calculate IPv4 netmask from prefix length
+uint32_t prefix_to_netmask_ipv4(uint8_t prefix_len) {
+  return netmask_of<IPv4Family>(prefix_len);
+}
+
+// Calculate IPv4 hostmask from prefix length (inverse of netmask)
+uint32_t prefix_to_hostmask_ipv4(uint8_t prefix_len) {
+  return hostmask_of<IPv4Family>(prefix_len);
+}
+
+// Calculate IPv6 netmask from prefix length
+void prefix_to_netmask_ipv6(uint8_t prefix_len, uint8_t *netmask) {
+  store_be128(netmask_of<IPv6Family>(prefix_len), netmask);
+}
+
+// Calculate IPv6 hostmask from prefix length (inverse of netmask)
+void prefix_to_hostmask_ipv6(uint8_t prefix_len, uint8_t *hostmask) {
+  store_be128(hostmask_of<IPv6Family>(prefix_len), hostmask);
+}
+
+// Validate CIDR network address (no host bits set)
+bool validate_cidr_network(uint32_t address, uint8_t netmask) {
+  if (netmask > IPV4_MAX_PREFIXLEN) return false;
+  if (netmask == 0) return true;
+  return (address & hostmask_of<IPv4Family>(netmask)) == 0;
+}
+
+// Validate IPv6 CIDR network address (no host bits set)
+bool validate_cidr_network_ipv6(const uint8_t *address, uint8_t netmask) {
+  if (netmask > IPV6_MAX_PREFIXLEN) return false;
+  if (netmask == 0) return true;
+  return (load_be128(address) & hostmask_of<IPv6Family>(netmask)) == 0;
+}
+
+// ============================================================================
+// Simple Extractors
+// ============================================================================
+
+// family(inet) → int
+// Extract family of address; 4 for IPv4, 6 for IPv6
+int inet_family(const unsigned char *buffer, size_t buffer_size) {
+  uint8_t family = get_address_family(buffer, buffer_size);
+
+  if (family == AF_INET_VAL) {
+    return 4;  // IPv4
+  } else if (family == AF_INET6_VAL) {
+    return 6;  // IPv6
+  }
+
+  return -1;  // Unknown family
+}
+
+// masklen(inet) → int
+// Extract netmask length
+int inet_masklen(const unsigned char *buffer, size_t buffer_size) {
+  if (buffer == nullptr || buffer_size < sizeof(IPv4Network)) {
+    return -1;  // Error
+  }
+
+  return with_family(buffer, buffer_size, -1, [&](auto family) -> int {
+    using Family = decltype(family);
+    return load_network<Family>(buffer).netmask;
+  });
+}
+
+// host(inet) → text
+// Extract IP address as text (without netmask)
+// Uncached; inet_host() goes through the format cache
+static bool inet_host_text(const unsigned char *buffer, size_t buffer_size, char *result, size_t result_size, size_t *result_length) {
+  if (buffer == nullptr || buffer_size < sizeof(IPv4Network) || result == nullptr) {
+    return true;  // Error
+  }
+
+  return with_family(buffer, buffer_size, true, [&](auto family) {
+    using Family = decltype(family);
+    auto net = load_network<Family>(buffer);
+    return store_text<Family>(Family::address(net), -1, result, result_size,
+                              result_length);
+  });
+}
+
+bool inet_host(const unsigned char *buffer, size_t buffer_size, char *result, size_t result_size, size_t *result_length) {
+  return decode_cached(DecodeKind::kHost, inet_host_text, buffer, buffer_size,
+                       result, result_size, result_length);
+}
+
+// text(inet) → text
+// Extract IP address and netmask length as text (always include prefix)
+bool inet_text(const unsigned char *buffer, size_t buffer_size, char *result, size_t result_size, size_t *result_length) {
+  if (buffer == nullptr || buffer_size < sizeof(IPv4Network) || result == nullptr) {
+    return true;  // Error
+  }
+
+  return with_family(buffer, buffer_size, true, [&](auto family) {
+    using Family = decltype(family);
+    auto net = load_network<Family>(buffer);
+    return store_text<Family>(Family::address(net), net.netmask, result,
+                              result_size, result_length);
+  });
+}
+
+// ============================================================================
+// Mask Calculations
+// ============================================================================
+
+// netmask(inet) → inet
+// Construct netmask for network
+bool inet_netmask(const unsigned char *buffer, size_t buffer_size,
+                  unsigned char *result_buffer, size_t *result_length) {
+  if (buffer == nullptr || buffer_size < sizeof(IPv4Network) ||
+      result_buffer == nullptr || result_length == nullptr) {
+    return true;  // Error
+  }
+
+  return with_family(buffer, buffer_size, true, [&](auto family) {
+    using Family = decltype(family);
+    auto net = load_network<Family>(buffer);
+
+    // Netmask is always shown as a single host (/32 or /128)
+    return store_network<Family>(netmask_of<Family>(net.netmask),
+                                 Family::kMaxPrefixLen, ADDR_FLAG_INET,
+                                 result_buffer, result_length);
+  });
+}
+
+// hostmask(inet) → inet
+// Construct host mask for network (inverse of netmask)
+bool inet_hostmask(const unsigned char *buffer, size_t buffer_size,
+                   unsigned char *result_buffer, size_t *result_length) {
+  if (buffer == nullptr || buffer_size < sizeof(IPv4Network) ||
+      result_buffer == nullptr || result_length == nullptr) {
+    return true;  // Error
+  }
+
+  return with_family(buffer, buffer_size, true, [&](auto family) {
+    using Family = decltype(family);
+    auto net = load_network<Family>(buffer);
+
+    // Hostmask is always shown as a single host (/32 or /128)
+    return store_network<Family>(hostmask_of<Family>(net.netmask),
+                                 Family::kMaxPrefixLen, ADDR_FLAG_INET,
+                                 result_buffer, result_length);
+  });
+}
+
+// broadcast(inet) → inet
+// Calculate broadcast address for network
+bool inet_broadcast(const unsigned char *buffer, size_t buffer_size,
+                    unsigned char *result_buffer, size_t *result_length) {
+  if (buffer == nullptr || buffer_size < sizeof(IPv4Network) ||
+      result_buffer == nullptr || result_length == nullptr) {
+    return true;  // Error
+  }
+
+  return with_family(buffer, buffer_size, true, [&](auto family) {
+    using Family = decltype(family);
+    auto net = load_network<Family>(buffer);
+
+    // Calculate broadcast: address OR hostmask
+    return store_network<Family>(
+        Family::address(net) | hostmask_of<Family>(net.netmask), net.netmask,
+        ADDR_FLAG_INET, result_buffer, result_length);
+  });
+}
+
+// network(inet) → cidr
+// Extract network part of address (zero out host bits)
+bool inet_network(const unsigned char *buffer, size_t buffer_size,
+                  unsigned char *result_buffer, size_t *result_length) {
+  if (buffer == nullptr || buffer_size < sizeof(IPv4Network) ||
+      result_buffer == nullptr || result_length == nullptr) {
+    return true;  // Error
+  }
+
+  return with_family(buffer, buffer_size, true, [&](auto family) {
+    using Family = decltype(family);
+    auto net = load_network<Family>(buffer);
+
+    // Calculate network: address AND netmask, as a strict CIDR value
+    return store_network<Family>(
+        Family::address(net) & netmask_of<Family>(net.netmask), net.netmask,
+        ADDR_FLAG_CIDR, result_buffer, result_length);
+  });
+}
+
+// ============================================================================
+// Modifiers
+// ============================================================================
+
+// set_masklen(inet, int) → inet
+// Set netmask length for inet value (does not modify address bits)
+bool inet_set_masklen(const unsigned char *buffer, size_t buffer_size,
+                      int new_masklen, unsigned char *result_buffer, size_t *result_length) {
+  if (buffer == nullptr || buffer_size < sizeof(IPv4Network) ||
+      result_buffer == nullptr || result_length == nullptr) {
+    return true;  // Error
+  }
+
+  return with_family(buffer, buffer_size, true, [&](auto family) {
+    using Family = decltype(family);
+    if (new_masklen < 0 || new_masklen > Family::kMaxPrefixLen) {
+      return true;  // Invalid masklen
+    }
+
+    auto net = load_network<Family>(buffer);
+    return store_network<Family>(Family::address(net), new_masklen,
+                                 ADDR_FLAG_INET, result_buffer, result_length);
+  });
+}
+
+// set_masklen(cidr, int) → cidr
+// Set netmask length for cidr value (zeros out host bits)
+bool cidr_set_masklen(const unsigned char *buffer, size_t buffer_size,
+                      int new_masklen, unsigned char *result_buffer, size_t *result_length) {
+  if (buffer == nullptr || buffer_size < sizeof(IPv4Network) ||
+      result_buffer == nullptr || result_length == nullptr) {
+    return true;  // Error
+  }
+
+  return with_family(buffer, buffer_size, true, [&](auto family) {
+    using Family = decltype(family);
+    if (new_masklen < 0 || new_masklen > Family::kMaxPrefixLen) {
+      return true;  // Invalid masklen
+    }
+
+    auto net = load_network<Family>(buffer);
+    return store_network<Family>(
+        Family::address(net) & netmask_of<Family>(new_masklen), new_masklen,
+        ADDR_FLAG_CIDR, result_buffer, result_length);
+  });
+}
+
+// trunc(macaddr) → macaddr
+// Set last 3 bytes to zero (keep manufacturer OUI)
+bool macaddr_trunc(const unsigned char *buffer, size_t buffer_size,
+                   unsigned char *result_buffer, size_t *result_length) {
+  if (buffer == nullptr || buffer_size < sizeof(MacAddr) ||
+      result_buffer == nullptr || result_length == nullptr) {
+    return true;  // Error
+  }
+
+  MacAddr mac;
+  memcpy(&mac, buffer, sizeof(MacAddr));
+
+  // Keep first 3 bytes (OUI), zero last 3 bytes
+  mac.address[3] = 0;
+  mac.address[4] = 0;
+  mac.address[5] = 0;
+
+  memcpy(result_buffer, &mac, sizeof(MacAddr));
+  *result_length = sizeof(MacAddr);
+  return false;  // Success
+}
+
+// ============================================================================
+// MAC Address Integers
+// ============================================================================
+
+// macaddr_to_bigint(macaddr) → bigint
+// The six octets as a big-endian integer: 08:00:2b:01:02:03 is 0x08002b010203
+bool macaddr_to_bigint(const unsigned char *buffer, size_t buffer_size,
+                       long long *value) {
+  if (buffer == nullptr || buffer_size < sizeof(MacAddr) || value == nullptr) {
+    return true;  // Error
+  }
+
+  *value = static_cast<long long>(load_be48(buffer));
+  return false;  // Success
+}
+
+// macaddr_from_bigint(bigint) → macaddr
+// Inverse of macaddr_to_bigint; values outside 0 .. 2^48-1 are an error
+bool macaddr_from_bigint(long long value, unsigned char *result_buffer,
+                         size_t *result_length) {
+  if (result_buffer == nullptr || result_length == nullptr ||
+      value < 0 || value > static_cast<long long>(kMaxMacAddrInteger)) {
+    return true;  // Error
+  }
+
+  // The low six bytes of the big-endian 64-bit form
+  uint8_t bytes[8];
+  store_be64(static_cast<uint64_t>(value), bytes);
+  memcpy(result_buffer, bytes + 2, sizeof(MacAddr));
+  *result_length = sizeof(MacAddr);
+  return false;  // Success
+}
+
+// ============================================================================
+// Formatting (Abbreviation)
+// ============================================================================
+
+// abbrev(inet) → text
+// Abbreviated display format - omit /32 and /128 for single hosts
+bool inet_abbrev(const unsigned char *buffer, size_t buffer_size, char *result, size_t result_size, size_t *result_length) {
+  if (buffer == nullptr || buffer_size < sizeof(IPv4Network) || result == nullptr) {
+    return true;  // Error
+  }
+
+  return with_family(buffer, buffer_size, true, [&](auto family) {
+    using Family = decltype(family);
+    auto net = load_network<Family>(buffer);
+    int masklen = net.netmask == Family::kMaxPrefixLen ? -1 : net.netmask;
+    return store_text<Family>(Family::address(net), masklen, result,
+                              result_size, result_length);
+  });
+}
+
+// abbrev(cidr) → text
+// Abbreviated display format - show minimal significant octets
+bool cidr_abbrev(const unsigned char *buffer, size_t buffer_size, char *result, size_t result_size, size_t *result_length) {
+  if (buffer == nullptr || buffer_size < sizeof(IPv4Network) || result == nullptr) {
+    return true;  // Error
+  }
+
+  uint8_t family = get_address_family(buffer, buffer_size);
+
+  if (family == AF_INET_VAL) {
+    IPv4Network net = load_network<IPv4Family>(buffer);
+
+    // Calculate how many octets we need to show based on netmask
+    int significant_octets = (net.netmask + 7) / 8;  // Round up
+    if (significant_octets == 0) significant_octets = 1;  // Show at least first octet
+
+    // Extract octets
+    uint8_t octets[4];
+    octets[0] = (net.address >> 24) & 0xFF;
+    octets[1] = (net.address >> 16) & 0xFF;
+    octets[2] = (net.address >> 8) & 0xFF;
+    octets[3] = net.address & 0xFF;
+
+    // All four octets is the plain inet_text form
+    if (significant_octets == 4) {
+      return store_text<IPv4Family>(net.address, net.netmask, result,
+                                    result_size, result_length);
+    }
+
+    // Build abbreviated address string
+    char text[IPv4Family::kMaxString];
+    int len;
+    if (significant_octets == 1) {
+      len = snprintf(text, sizeof(text), "%u/%u", octets[0], net.netmask);
+    } else if (significant_octets == 2) {
+      len = snprintf(text, sizeof(text), "%u.%u/%u", octets[0], octets[1],
+                     net.netmask);
+    } else {
+      len = snprintf(text, sizeof(text), "%u.%u.%u/%u", octets[0], octets[1],
+                     octets[2], net.netmask);
+    }
+    if (static_cast<size_t>(len) + 1 > result_size) return true;
+    memcpy(result, text, len + 1);
+    *result_length = len;
+    return false;  // Success
+
+  } else if (family == AF_INET6_VAL) {
+    // For IPv6, just use the same format as inet_text for now
+    // A more sophisticated implementation would abbreviate groups
+    return inet_text(buffer, buffer_size, result, result_size, result_length);
+  }
+
+  return true;  // Error: unknown family
+}
+
+// ============================================================================
+// Prefix Arithmetic
+// ============================================================================
+
+// common_prefix_len(inet, inet) → int
+// Number of leading address bits shared by both values (masklens ignored)
+int inet_common_prefix_len(const unsigned char *buffer1, size_t buffer1_size,
+                           const unsigned char *buffer2, size_t buffer2_size) {
+  if (get_address_family(buffer1, buffer1_size) !=
+      get_address_family(buffer2, buffer2_size)) {
+    return -1;  // Error: mismatched families
+  }
+
+  return with_family(buffer1, buffer1_size, -1, [&](auto family) {
+    using Family = decltype(family);
+    return Family::clz(Family::address(load_network<Family>(buffer1)) ^
+                       Family::address(load_network<Family>(buffer2)));
+  });
+}
+
+// merge(inet, inet) → cidr
+// Smallest network which includes both of the given networks
+bool inet_merge(const unsigned char *buffer1, size_t buffer1_size,
+                const unsigned char *buffer2, size_t buffer2_size,
+                unsigned char *result_buffer, size_t *result_length) {
+  if (result_buffer == nullptr || result_length == nullptr) {
+    return true;  // Error
+  }
+
+  if (get_address_family(buffer1, buffer1_size) !=
+      get_address_family(buffer2, buffer2_size)) {
+    return true;  // Error: cannot merge addresses from different families
+  }
+
+  return with_family(buffer1, buffer1_size, true, [&](auto family) {
+    using Family = decltype(family);
+    auto net1 = load_network<Family>(buffer1);
+    auto net2 = load_network<Family>(buffer2);
+    auto address1 = Family::address(net1);
+
+    int bits = Family::clz(address1 ^ Family::address(net2));
+    if (net1.netmask < bits) bits = net1.netmask;
+    if (net2.netmask < bits) bits = net2.netmask;
+
+    return store_network<Family>(address1 & netmask_of<Family>(bits), bits,
+                                 ADDR_FLAG_CIDR, result_buffer, result_length);
+  });
+}
+
+// xor_distance(inet, inet) → inet
+// Kademlia-style XOR metric of the two addresses, as a full-length INET so
+// that ORDER BY on the result ranks neighbours by distance
+bool inet_xor_distance(const unsigned char *buffer1, size_t buffer1_size,
+                       const unsigned char *buffer2, size_t buffer2_size,
+                       unsigned char *result_buffer, size_t *result_length) {
+  if (result_buffer == nullptr || result_length == nullptr) {
+    return true;  // Error
+  }
+
+  if (get_address_family(buffer1, buffer1_size) !=
+      get_address_family(buffer2, buffer2_size)) {
+    return true;  // Error: unknown or mismatched families
+  }
+
+  return with_family(buffer1, buffer1_size, true, [&](auto family) {
+    using Family = decltype(family);
+    return store_network<Family>(
+        Family::address(load_network<Family>(buffer1)) ^
+            Family::address(load_network<Family>(buffer2)),
+        Family::kMaxPrefixLen, ADDR_FLAG_INET, result_buffer, result_length);
+  });
+}
+
+// ============================================================================
+// Enumeration
+// ============================================================================
+
+// Append raw bytes to a result buffer, keeping it null-terminated
+static inline bool append_bytes(char *result, size_t result_size, size_t *pos,
+                                const char *bytes, size_t len) {
+  if (*pos + len + 1 > result_size) {
+    return true;  // Error: result buffer too small
+  }
+  memcpy(result + *pos, bytes, len);
+  *pos += len;
+  result[*pos] = '\0';
+  return false;
+}
+
+// Append a formatted address as an element of a JSON array
+static inline bool append_json_element(char *result, size_t result_size,
+                                       size_t *pos, bool first,
+                                       const char *text, size_t len) {
+  if (*pos + len + 4 > result_size) {
+    return true;  // Error: result buffer too small
+  }
+  if (!first) {
+    result[(*pos)++] = ',';
+  }
+  result[(*pos)++] = '"';
+  memcpy(result + *pos, text, len);
+  *pos += len;
+  result[(*pos)++] = '"';
+  result[*pos] = '\0';
+  return false;
+}
+
+// Append a formatted address to a JSON array
+template <class Family>
+static inline bool append_json_address(char *result, size_t result_size,
+                                       size_t *pos, bool first,
+                                       typename Family::Word address,
+                                       int masklen) {
+  char entry[Family::kMaxString];
+  size_t len = format_address<Family>(address, masklen, entry, sizeof(entry));
+  return append_json_element(result, result_size, pos, first, entry, len);
+}
+
+// subnets(cidr, int, int) → text
+// JSON array of the subnets of the given prefix length, in address order,
+// produced by repeatedly adding the subnet size to the network address
+bool cidr_subnets(const unsigned char *buffer, size_t buffer_size,
+                  int new_masklen, long long limit,
+                  char *result, size_t result_size, size_t *result_length) {
+  if (buffer == nullptr || result == nullptr || result_length == nullptr ||
+      limit < 0) {
+    return true;  // Error
+  }
+
+  size_t pos = 0;
+  if (append_bytes(result, result_size, &pos, "[", 1)) {
+    return true;
+  }
+
+  bool error = with_family(buffer, buffer_size, true, [&](auto family) {
+    using Family = decltype(family);
+    using Word = typename Family::Word;
+    auto net = load_network<Family>(buffer);
+    if (new_masklen < net.netmask || new_masklen > Family::kMaxPrefixLen) {
+      return true;  // Invalid masklen
+    }
+
+    int extra_bits = new_masklen - net.netmask;
+    uint64_t count = extra_bits >= 64 ? UINT64_MAX : 1ULL << extra_bits;
+    Word step = new_masklen == 0
+                    ? Word(0)
+                    : Word(1) << (Family::kMaxPrefixLen - new_masklen);
+    Word address = Family::address(net) & netmask_of<Family>(net.netmask);
+
+    for (uint64_t i = 0; i < count && i < static_cast<uint64_t>(limit); i++) {
+      if (append_json_address<Family>(result, result_size, &pos, i == 0,
+                                      address, new_masklen)) {
+        return true;
+      }
+      address += step;
+    }
+    return false;
+  });
+  if (error) {
+    return true;
+  }
+
+  if (append_bytes(result, result_size, &pos, "]", 1)) {
+    return true;
+  }
+  *result_length = pos;
+  return false;  // Success
+}
+
+// hosts(cidr, int) → text
+// JSON array of the usable host addresses in the network, in address order.
+// Like Python's ipaddress hosts(), the IPv4 network and broadcast addresses
+// and the IPv6 Subnet-Router anycast address are skipped, except in /31,
+// /32, /127 and /128 networks.
+bool cidr_hosts(const unsigned char *buffer, size_t buffer_size,
+                long long limit,
+                char *result, size_t result_size, size_t *result_length) {
+  if (buffer == nullptr || result == nullptr || result_length == nullptr ||
+      limit < 0) {
+    return true;  // Error
+  }
+
+  size_t pos = 0;
+  if (append_bytes(result, result_size, &pos, "[", 1)) {
+    return true;
+  }
+
+  bool error = with_family(buffer, buffer_size, true, [&](auto family) {
+    using Family = decltype(family);
+    auto net = load_network<Family>(buffer);
+
+    auto first = Family::address(net) & netmask_of<Family>(net.netmask);
+    auto last = first | hostmask_of<Family>(net.netmask);
+    if (net.netmask < Family::kMaxPrefixLen - 1) {
+      first++;
+      if (Family::kHasBroadcast) last--;
+    }
+
+    auto address = first;
+    for (long long i = 0; i < limit; i++) {
+      if (append_json_address<Family>(result, result_size, &pos, i == 0,
+                                      address, -1)) {
+        return true;
+      }
+      if (address == last) break;
+      address++;
+    }
+    return false;
+  });
+  if (error) {
+    return true;
+  }
+
+  if (append_bytes(result, result_size, &pos, "]", 1)) {
+    return true;
+  }
+  *result_length = pos;
+  return false;  // Success
+}
+
+// range_to_cidrs(inet, inet) → text
+// JSON array of the minimal list of CIDR networks exactly covering the
+// inclusive address range [start, end]. Each block is the largest one that
+// is both aligned at the current address (trailing zeros) and no larger than
+// the remaining range (leading zeros of its length).
+bool inet_range_to_cidrs(const unsigned char *start_buffer, size_t start_size,
+                         const unsigned char *end_buffer, size_t end_size,
+                         char *result, size_t result_size,
+                         size_t *result_length) {
+  if (result == nullptr || result_length == nullptr) {
+    return true;  // Error
+  }
+
+  if (get_address_family(start_buffer, start_size) !=
+      get_address_family(end_buffer, end_size)) {
+    return true;  // Error: unknown or mismatched families
+  }
+
+  size_t pos = 0;
+  if (append_bytes(result, result_size, &pos, "[", 1)) {
+    return true;
+  }
+
+  bool error = with_family(start_buffer, start_size, true, [&](auto family) {
+    using Family = decltype(family);
+    using Word = typename Family::Word;
+    constexpr int kBits = Family::kMaxPrefixLen;
+
+    Word current = Family::address(load_network<Family>(start_buffer));
+    Word last = Family::address(load_network<Family>(end_buffer));
+    if (current > last) {
+      return true;  // Error: empty range
+    }
+
+    for (bool first = true;; first = false) {
+      // The range length wraps to zero only when it covers the whole space
+      Word remaining = last - current + 1;
+      int fit_bits = remaining == 0 ? kBits : kBits - 1 - Family::clz(remaining);
+      int align_bits = Family::ctz(current);
+      int block_bits = align_bits < fit_bits ? align_bits : fit_bits;
+
+      if (append_json_address<Family>(result, result_size, &pos, first,
+                                      current, kBits - block_bits)) {
+        return true;
+      }
+
+      Word block_last = current + hostmask_of<Family>(kBits - block_bits);
+      if (block_last == last) break;
+      current = block_last + 1;
+    }
+    return false;
+  });
+  if (error) {
+    return true;
+  }
+
+  if (append_bytes(result, result_size, &pos, "]", 1)) {
+    return true;
+  }
+  *result_length = pos;
+  return false;  // Success
+}
+
+// ============================================================================
+// Address Lists
+// ============================================================================
+
+// Separator used when the caller passes an empty one
+static constexpr std::string_view kDefaultListSeparator = ",";
+
+// Split the next non-empty, whitespace-trimmed token off the front of list
+static bool next_list_token(std::string_view *list, std::string_view separator,
+                            std::string_view *token) {
+  while (!list->empty()) {
+    size_t cut = list->find(separator);
+    std::string_view piece = list->substr(0, cut);
+    list->remove_prefix(cut == std::string_view::npos
+                            ? list->size()
+                            : cut + separator.size());
+
+    while (!piece.empty() &&
+           std::isspace(static_cast<unsigned char>(piece.front()))) {
+      piece.remove_prefix(1);
+    }
+    while (!piece.empty() &&
+           std::isspace(static_cast<unsigned char>(piece.back()))) {
+      piece.remove_suffix(1);
+    }
+    if (!piece.empty()) {
+      *token = piece;
+      return true;
+    }
+  }
+  return false;
+}
+
+static inline std::string_view list_separator(const char *sep,
+                                              size_t sep_len) {
+  if (sep == nullptr || sep_len == 0) {
+    return kDefaultListSeparator;
+  }
+  return std::string_view(sep, sep_len);
+}
+
+// normalize_list(text, text) → text
+// Parse every address in a separated list and re-emit it in canonical INET
+// form, joined by the same separator
+bool inet_normalize_list(const char *list, size_t list_len,
+                         const char *sep, size_t sep_len,
+                         char *result, size_t result_size,
+                         size_t *result_length) {
+  if (list == nullptr || result == nullptr || result_size == 0 ||
+      result_length == nullptr) {
+    return true;  // Error
+  }
+
+  std::string_view rest(list, list_len);
+  std::string_view separator = list_separator(sep, sep_len);
+  std::string_view token;
+  size_t pos = 0;
+  result[0] = '\0';
+
+  for (bool first = true; next_list_token(&rest, separator, &token);
+       first = false) {
+    unsigned char value[sizeof(IPv6Network)];
+    size_t value_len;
+    if (encode_inet(value, sizeof(value), token.data(), token.size(),
+                    &value_len)) {
+      return true;  // Error: invalid address in list
+    }
+    if (!first && append_bytes(result, result_size, &pos, separator.data(),
+                               separator.size())) {
+      return true;
+    }
+    size_t text_len;
+    if (decode_inet(value, value_len, result + pos, result_size - pos,
+                    &text_len)) {
+      return true;  // Error: result buffer too small
+    }
+    pos += text_len;
+  }
+
+  *result_length = pos;
+  return false;  // Success
+}
+
+// validate_list(text, text) → int
+// 1-based position of the first invalid address in a separated list
+// (empty entries are skipped), or 0 when every entry parses
+int inet_validate_list(const char *list, size_t list_len,
+                       const char *sep, size_t sep_len) {
+  if (list == nullptr) {
+    return 0;
+  }
+
+  std::string_view rest(list, list_len);
+  std::string_view separator = list_separator(sep, sep_len);
+  std::string_view token;
+
+  for (int position = 1; next_list_token(&rest, separator, &token);
+       position++) {
+    unsigned char value[sizeof(IPv6Network)];
+    size_t value_len;
+    if (encode_inet(value, sizeof(value), token.data(), token.size(),
+                    &value_len)) {
+      return position;
+    }
+  }
+  return 0;
+}
+
+// Sort key of an INET value: family rank, 16 big-endian address bytes and
+// masklen, so that byte order matches cmp_inet ordering
+static constexpr size_t kListSortKeyLength = 18;
+
+struct ListEntry {
+  uint8_t key[kListSortKeyLength];
+  unsigned char value[sizeof(IPv6Network)];
+  size_t length;
+};
+
+// LSD radix sort on the binary sort key, skipping byte positions where all
+// keys agree (e.g. the 12 padding bytes of an IPv4-only list)
+static void radix_sort_list_entries(std::vector<ListEntry> *entries) {
+  if (entries->size() < 2) {
+    return;
+  }
+
+  std::vector<ListEntry> scratch(entries->size());
+  for (int byte = kListSortKeyLength - 1; byte >= 0; byte--) {
+    size_t counts[256] = {0};
+    for (const ListEntry &entry : *entries) {
+      counts[entry.key[byte]]++;
+    }
+    if (counts[(*entries)[0].key[byte]] == entries->size()) {
+      continue;  // Every key has the same byte here
+    }
+
+    size_t offsets[256];
+    size_t total = 0;
+    for (int i = 0; i < 256; i++) {
+      offsets[i] = total;
+      total += counts[i];
+    }
+    for (const ListEntry &entry : *entries) {
+      scratch[offsets[entry.key[byte]]++] = entry;
+    }
+    entries->swap(scratch);
+  }
+}
+
+// sort_list(text, text) → text
+// Parse a separated list of addresses and emit it in INET sort order with
+// duplicates removed, in canonical form joined by the same separator
+bool inet_sort_list(const char *list, size_t list_len,
+                    const char *sep, size_t sep_len,
+                    char *result, size_t result_size, size_t *result_length) {
+  if (list == nullptr || result == nullptr || result_size == 0 ||
+      result_length == nullptr) {
+    return true;  // Error
+  }
+
+  std::string_view rest(list, list_len);
+  std::string_view separator = list_separator(sep, sep_len);
+  std::string_view token;
+  std::vector<ListEntry> entries;
+
+  while (next_list_token(&rest, separator, &token)) {
+    ListEntry entry;
+    if (encode_inet(entry.value, sizeof(entry.value), token.data(),
+                    token.size(), &entry.length)) {
+      return true;  // Error: invalid address in list
+    }
+
+    memset(entry.key, 0, sizeof(entry.key));
+    if (get_address_family(entry.value, entry.length) == AF_INET_VAL) {
+      IPv4Network net;
+      memcpy(&net, entry.value, sizeof(IPv4Network));
+      entry.key[0] = 0;
+      entry.key[1] = (net.address >> 24) & 0xFF;
+      entry.key[2] = (net.address >> 16) & 0xFF;
+      entry.key[3] = (net.address >> 8) & 0xFF;
+      entry.key[4] = net.address & 0xFF;
+      entry.key[17] = net.netmask;
+    } else {
+      entry.key[0] = 1;
+      memcpy(entry.key + 1, entry.value, 16);
+      entry.key[17] = entry.value[16];
+    }
+    entries.push_back(entry);
+  }
+
+  radix_sort_list_entries(&entries);
+
+  size_t pos = 0;
+  result[0] = '\0';
+  for (size_t i = 0; i < entries.size(); i++) {
+    if (i > 0 && memcmp(entries[i].key, entries[i - 1].key,
+                        kListSortKeyLength) == 0) {
+      continue;  // Duplicate
+    }
+    if (pos > 0 && append_bytes(result, result_size, &pos, separator.data(),
+                                separator.size())) {
+      return true;
+    }
+    size_t text_len;
+    if (decode_inet(entries[i].value, entries[i].length, result + pos,
+                    result_size - pos, &text_len)) {
+      return true;  // Error: result buffer too small
+    }
+    pos += text_len;
+  }
+
+  *result_length = pos;
+  return false;  // Success
+}
+
+// ============================================================================
+// Containment
+// ============================================================================
+
+// Precompute the masked network words of an INET/CIDR value
+bool compile_network(const unsigned char *buffer, size_t buffer_size,
+                     CompiledNetwork *compiled) {
+  if (compiled == nullptr) {
+    return true;  // Error
+  }
+
+  uint8_t family = get_address_family(buffer, buffer_size);
+
+  if (family == AF_INET_VAL) {
+    IPv4Network net;
+    memcpy(&net, buffer, sizeof(IPv4Network));
+    compiled->family = AF_INET_VAL;
+    compiled->masklen = net.netmask;
+    compiled->mask_hi =
+        static_cast<uint64_t>(netmask_of<IPv4Family>(net.netmask)) << 32;
+    compiled->mask_lo = 0;
+    compiled->network_hi =
+        (static_cast<uint64_t>(net.address) << 32) & compiled->mask_hi;
+    compiled->network_lo = 0;
+    return false;  // Success
+
+  } else if (family == AF_INET6_VAL) {
+    uint128_t mask = netmask_of<IPv6Family>(buffer[16]);
+    uint128_t network = load_be128(buffer) & mask;
+    compiled->family = AF_INET6_VAL;
+    compiled->masklen = buffer[16];
+    compiled->mask_hi = static_cast<uint64_t>(mask >> 64);
+    compiled->mask_lo = static_cast<uint64_t>(mask);
+    compiled->network_hi = static_cast<uint64_t>(network >> 64);
+    compiled->network_lo = static_cast<uint64_t>(network);
+    return false;  // Success
+  }
+
+  return true;  // Error: unknown family
+}
+
+// Whether the value lies within the compiled network: 1 if it does, 0 if not
+// (including a family mismatch), -1 on malformed input. With or_equals the
+// value may be the network itself (<<=), otherwise it must be a strict
+// subnet or host (<<).
+int network_includes(const CompiledNetwork &network,
+                     const unsigned char *buffer, size_t buffer_size,
+                     bool or_equals) {
+  uint8_t family = get_address_family(buffer, buffer_size);
+  if (family == 0) {
+    return -1;  // Error: unknown family
+  }
+  if (family != network.family) {
+    return 0;
+  }
+
+  uint64_t hi, lo;
+  uint8_t masklen;
+  if (family == AF_INET_VAL) {
+    IPv4Network net;
+    memcpy(&net, buffer, sizeof(IPv4Network));
+    hi = static_cast<uint64_t>(net.address) << 32;
+    lo = 0;
+    masklen = net.netmask;
+  } else {
+    hi = load_be64(buffer);
+    lo = load_be64(buffer + 8);
+    masklen = buffer[16];
+  }
+
+  if (masklen < network.masklen ||
+      (!or_equals && masklen == network.masklen)) {
+    return 0;
+  }
+  return ((hi & network.mask_hi) == network.network_hi &&
+          (lo & network.mask_lo) == network.network_lo)
+             ? 1
+             : 0;
+}
+
+
+// ============================================================================
+// Compact Single-Family Types (INET4, INET6)
+// ============================================================================
+
+// INET4 and INET6 store the big-endian address followed by the masklen
+// byte. With the family fixed by the type there is no tag to check, and the
+// address plus masklen compare as one integer key.
+
+static inline uint32_t load_be32(const uint8_t *p) {
+  uint32_t v;
+  memcpy(&v, p, sizeof(v));
+  return __builtin_bswap32(v);
+}
+
+static inline void store_be32(uint32_t value, uint8_t *p) {
+  value = __builtin_bswap32(value);
+  memcpy(p, &value, sizeof(value));
+}
+
+// Narrow an IPv4 INET/CIDR value to INET4
+bool inet_to_inet4(const unsigned char *buffer, size_t buffer_size,
+                   unsigned char *result_buffer, size_t *result_length) {
+  if (result_buffer == nullptr ||
+      get_address_family(buffer, buffer_size) != AF_INET_VAL) {
+    return MarkInvalid(result_length);
+  }
+
+  IPv4Network net;
+  memcpy(&net, buffer, sizeof(IPv4Network));
+  store_be32(net.address, result_buffer);
+  result_buffer[4] = net.netmask;
+  *result_length = kInet4Length;
+  return false;  // Success
+}
+
+// Widen an INET4 value to INET
+bool inet4_to_inet(const unsigned char *buffer, size_t buffer_size,
+                   unsigned char *result_buffer, size_t *result_length) {
+  if (buffer == nullptr || result_buffer == nullptr ||
+      buffer_size != kInet4Length || buffer[4] > IPV4_MAX_PREFIXLEN) {
+    return MarkInvalid(result_length);
+  }
+
+  IPv4Network net;
+  memset(&net, 0, sizeof(net));
+  net.address = load_be32(buffer);
+  net.netmask = buffer[4];
+  net.family = AF_INET_VAL;
+  net.flags = ADDR_FLAG_INET;
+  memcpy(result_buffer, &net, sizeof(IPv4Network));
+  *result_length = sizeof(IPv4Network);
+  return false;  // Success
+}
+
+// Narrow an IPv6 INET/CIDR value to INET6
+bool inet_to_inet6(const unsigned char *buffer, size_t buffer_size,
+                   unsigned char *result_buffer, size_t *result_length) {
+  if (result_buffer == nullptr ||
+      get_address_family(buffer, buffer_size) != AF_INET6_VAL) {
+    return MarkInvalid(result_length);
+  }
+
+  memcpy(result_buffer, buffer, 16);
+  result_buffer[16] = buffer[16];
+  *result_length = kInet6Length;
+  return false;  // Success
+}
+
+// Widen an INET6 value to INET
+bool inet6_to_inet(const unsigned char *buffer, size_t buffer_size,
+                   unsigned char *result_buffer, size_t *result_length) {
+  if (buffer == nullptr || result_buffer == nullptr ||
+      buffer_size != kInet6Length || buffer[16] > IPV6_MAX_PREFIXLEN) {
+    return MarkInvalid(result_length);
+  }
+
+  IPv6Network net;
+  memcpy(net.address, buffer, 16);
+  net.netmask = buffer[16];
+  net.family = AF_INET6_VAL;
+  net.flags = ADDR_FLAG_INET;
+  memcpy(result_buffer, &net, sizeof(IPv6Network));
+  *result_length = sizeof(IPv6Network);
+  return false;  // Success
+}
+
+static bool encode_inet4_text(unsigned char *buffer, size_t buffer_size,
+                              const char *from, size_t from_len,
+                              size_t *length) {
+  unsigned char inet[sizeof(IPv6Network)];
+  size_t inet_length;
+  if (buffer_size < kInet4Length ||
+      encode_inet_cached(inet, sizeof(inet), from, from_len, &inet_length)) {
+    return MarkInvalid(length);
+  }
+  if (inet_to_inet4(inet, inet_length, buffer, length)) {
+    // Valid text of the other family
+    return ParseFailed(length, "inet4", RejectReason::kWrongFamily, from,
+                       from_len);
+  }
+  return false;
+}
+
+static bool decode_inet4_text(const unsigned char *buffer,
+                              size_t buffer_size, char *to, size_t to_size,
+                              size_t *to_length) {
+  unsigned char inet[sizeof(IPv4Network)];
+  size_t inet_length;
+  if (inet4_to_inet(buffer, buffer_size, inet, &inet_length)) {
+    return true;
+  }
+  return decode_inet_cached(inet, inet_length, to, to_size, to_length);
+}
+
+static bool encode_inet6_text(unsigned char *buffer, size_t buffer_size,
+                              const char *from, size_t from_len,
+                              size_t *length) {
+  unsigned char inet[sizeof(IPv6Network)];
+  size_t inet_length;
+  if (buffer_size < kInet6Length ||
+      encode_inet_cached(inet, sizeof(inet), from, from_len, &inet_length)) {
+    return MarkInvalid(length);
+  }
+  if (inet_to_inet6(inet, inet_length, buffer, length)) {
+    // Valid text of the other family
+    return ParseFailed(length, "inet6", RejectReason::kWrongFamily, from,
+                       from_len);
+  }
+  return false;
+}
+
+static bool decode_inet6_text(const unsigned char *buffer,
+                              size_t buffer_size, char *to, size_t to_size,
+                              size_t *to_length) {
+  unsigned char inet[sizeof(IPv6Network)];
+  size_t inet_length;
+  if (inet6_to_inet(buffer, buffer_size, inet, &inet_length)) {
+    return true;
+  }
+  return decode_inet_cached(inet, inet_length, to, to_size, to_length);
+}
+
+static int compare_inet4(const unsigned char *data1, size_t len1,
+                         const unsigned char *data2, size_t len2) {
+  assert(len1 == kInet4Length && len2 == kInet4Length);
+  (void)len1;
+  (void)len2;
+  return cmp_ipv4_fused(load_be32(data1), data1[4], load_be32(data2),
+                        data2[4]);
+}
+
+// INET6 shares the INET/CIDR IPv6 layout up to the masklen byte
+static int compare_inet6(const unsigned char *data1, size_t len1,
+                         const unsigned char *data2, size_t len2) {
+  assert(len1 == kInet6Length && len2 == kInet6Length);
+  (void)len1;
+  (void)len2;
+  return cmp_ipv6_fused(data1, data2);
+}
+
+bool encode_inet4(unsigned char *buffer, size_t buffer_size, const char *from,
+                  size_t from_len, size_t *length) {
+  return traced_encode(kProbeInet4, encode_inet4_text, buffer, buffer_size,
+                       from, from_len, length);
+}
+
+bool decode_inet4(const unsigned char *buffer, size_t buffer_size, char *to,
+                  size_t to_size, size_t *to_length) {
+  return traced_decode(kProbeInet4, decode_inet4_text, buffer, buffer_size,
+                       to, to_size, to_length);
+}
+
+bool encode_inet6(unsigned char *buffer, size_t buffer_size, const char *from,
+                  size_t from_len, size_t *length) {
+  return traced_encode(kProbeInet6, encode_inet6_text, buffer, buffer_size,
+                       from, from_len, length);
+}
+
+bool decode_inet6(const unsigned char *buffer, size_t buffer_size, char *to,
+                  size_t to_size, size_t *to_length) {
+  return traced_decode(kProbeInet6, decode_inet6_text, buffer, buffer_size,
+                       to, to_size, to_length);
+}
+
+int cmp_inet4(const unsigned char *data1, size_t len1,
+              const unsigned char *data2, size_t len2) {
+  return traced_compare(kProbeInet4, compare_inet4, data1, len1, data2, len2);
+}
+
+int cmp_inet6(const unsigned char *data1, size_t len1,
+              const unsigned char *data2, size_t len2) {
+  return traced_compare(kProbeInet6, compare_inet6, data1, len1, data2, len2);
+}
+
+int inet4_masklen(const unsigned char *buffer, size_t buffer_size) {
+  if (buffer == nullptr || buffer_size != kInet4Length) {
+    return -1;  // Error
+  }
+  return buffer[4];
+}
+
+int inet6_masklen(const unsigned char *buffer, size_t buffer_size) {
+  if (buffer == nullptr || buffer_size != kInet6Length) {
+    return -1;  // Error
+  }
+  return buffer[16];
+}
+
+} // namespace network_address
@@ -0,0 +1,413 @@
+/* Copyright (c) 2025 VillageSQL Contributors
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <https://www.gnu.org/licenses/>.
+ */
+
+// Core parsing, formatting and comparison routines for the INET, CIDR,
+// MACADDR and MACADDR8 types. Everything here works on raw buffers in the
+// on-disk layout and has no dependency on the VillageSQL SDK, so it can be
+// linked into unit tests, benchmarks, fuzzers and offline tools as well as
+// the extension itself. Functions returning bool return true on error.
+
+#ifndef NETWORK_ADDRESS_CORE_H
+#define NETWORK_ADDRESS_CORE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace network_address {
+
+// Data structure definitions for network address types
+
+// IPv4 network address structure (7 bytes total)
+struct IPv4Network {
+  uint32_t address;  // 4 bytes - network byte order
+  uint8_t netmask;   // 1 byte - CIDR prefix length
+  uint8_t family;    // 1 byte - address family (2 for IPv4)
+  uint8_t flags;     // 1 byte - type flags (CIDR vs INET)
+};
+
+// IPv6 network address structure (19 bytes total)
+struct IPv6Network {
+  uint8_t address[16]; // 16 bytes - IPv6 address
+  uint8_t netmask;     // 1 byte - CIDR prefix length
+  uint8_t family;      // 1 byte - address family (10 for IPv6)
+  uint8_t flags;       // 1 byte - type flags (CIDR vs INET)
+};
+
+// MAC address structure (6 bytes)
+struct MacAddr {
+  uint8_t address[6];  // 6 bytes - MAC address
+};
+
+// Extended MAC address structure (8 bytes)
+struct MacAddr8 {
+  uint8_t address[8];  // 8 bytes - EUI-64 MAC address
+};
+
+// Constants
+static constexpr uint8_t ADDR_FLAG_CIDR = 0x01;  // Strict CIDR validation
+static constexpr uint8_t ADDR_FLAG_INET = 0x02;  // INET allows host bits
+static constexpr uint8_t AF_INET_VAL = 2;        // IPv4 family
+static constexpr uint8_t AF_INET6_VAL = 10;      // IPv6 family
+static constexpr uint8_t IPV4_MAX_PREFIXLEN = 32;
+static constexpr uint8_t IPV6_MAX_PREFIXLEN = 128;
+
+// Maximum string lengths for display
+static constexpr size_t kMaxIPv4String = 18;   // xxx.xxx.xxx.xxx/32
+static constexpr size_t kMaxIPv6String = 44;   // full IPv6 with /128 + null
+static constexpr size_t kMaxMacAddrString = 17; // xx:xx:xx:xx:xx:xx
+static constexpr size_t kMaxMacAddr8String = 23; // xx:xx:xx:xx:xx:xx:xx:xx
+static constexpr size_t kMaxAddressList = 65535; // JSON array of addresses
+static constexpr size_t kMaxInputString = 128;   // longest accepted input text
+static constexpr size_t kInet4Length = 5;        // INET4: address + masklen
+static constexpr size_t kInet6Length = 17;       // INET6: address + masklen
+static constexpr uint64_t kMaxMacAddrInteger = 0xFFFFFFFFFFFFULL;  // 2^48-1
+
+// Vectorized parsing and formatting kernels are resolved once when the
+// library loads, to the widest set the CPU supports: "ssse3" or "sse2" on
+// x86-64, "neon" on AArch64, else "scalar". Setting
+// VSQL_NETWORK_ADDRESS_FORCE_SCALAR to anything but "0" in the server's
+// environment forces "scalar". kernel_set() names the active set;
+// select_kernels() re-resolves at run time (for tests and benchmarks; do
+// not call it while other threads are parsing) and returns the new name.
+const char *kernel_set();
+const char *select_kernels(bool force_scalar);
+
+// Address text parsing and formatting
+bool parse_ipv4_address(const char* addr_str, uint32_t* address);
+void format_ipv4_address(uint32_t address, char* buffer, size_t buffer_size);
+bool parse_ipv6_address(const char* addr_str, uint8_t* address);
+void format_ipv6_address(const uint8_t* address, char* buffer, size_t buffer_size);
+bool parse_mac_address(const char* mac_str, uint8_t* address, int expected_bytes);
+void format_mac_address(const uint8_t* address, char* buffer, size_t buffer_size, int bytes);
+bool validate_cidr_network(uint32_t address, uint8_t netmask);
+bool validate_cidr_network_ipv6(const uint8_t *address, uint8_t netmask);
+
+// Encoding/decoding functions for each type
+bool encode_cidr(unsigned char *buffer, size_t buffer_size, const char *from, size_t from_len, size_t *length);
+bool decode_cidr(const unsigned char *buffer, size_t buffer_size, char *to, size_t to_size, size_t *to_length);
+bool encode_inet(unsigned char *buffer, size_t buffer_size, const char *from, size_t from_len, size_t *length);
+bool decode_inet(const unsigned char *buffer, size_t buffer_size, char *to, size_t to_size, size_t *to_length);
+bool encode_macaddr(unsigned char *buffer, size_t buffer_size, const char *from, size_t from_len, size_t *length);
+bool decode_macaddr(const unsigned char *buffer, size_t buffer_size, char *to, size_t to_size, size_t *to_length);
+bool encode_macaddr8(unsigned char *buffer, size_t buffer_size, const char *from, size_t from_len, size_t *length);
+bool decode_macaddr8(const unsigned char *buffer, size_t buffer_size, char *to, size_t to_size, size_t *to_length);
+
+// Optional thread-local cache of encode_inet/encode_cidr/encode_macaddr
+// results keyed by the input text, for inputs that repeat (the same client
+// addresses on most rows of a log). Off by default; set_parse_cache_enabled
+// returns the previous setting. Stats are summed over all threads.
+struct CacheStats {
+  uint64_t hits;
+  uint64_t misses;
+  uint64_t evictions;  // misses that replaced another input's entry
+};
+bool set_parse_cache_enabled(bool enabled);
+bool parse_cache_enabled();
+CacheStats parse_cache_stats();
+
+// The same for decode_inet/decode_cidr/decode_macaddr/inet_host, keyed by
+// the stored bytes, for output that repeats a few values (GROUP BY keys)
+bool set_format_cache_enabled(bool enabled);
+bool format_cache_enabled();
+CacheStats format_cache_stats();
+
+// Call statistics for the extension's SQL functions and type callbacks,
+// compiled in when NETWORK_ADDRESS_STATS is set (the CMake option of that
+// name). A StatScope around a call counts it, and any NULL argument or
+// parse failure in it, in the calling thread's own slots; one call in
+// kLatencySamplePeriod per thread is also timed into a log2 histogram.
+// stats_json() sums all threads, less what reset_stats() last saw.
+#ifndef NETWORK_ADDRESS_STATS
+#define NETWORK_ADDRESS_STATS 0
+#endif
+static constexpr size_t kMaxStatFunctions = 128;
+static constexpr size_t kLatencyBuckets = 24;  // [2^b, 2^(b+1)) ns; last open
+static constexpr uint32_t kLatencySamplePeriod = 64;
+static constexpr size_t kMaxStatsJson = 65535;
+
+#if NETWORK_ADDRESS_STATS
+// Per function: calls, NULL-argument calls, parse failures, then the
+// latency histogram
+enum StatField : size_t {
+  kStatCalls,
+  kStatNulls,
+  kStatParseFailures,
+  kStatLatency
+};
+static constexpr size_t kStatFields = kStatLatency + kLatencyBuckets;
+static constexpr size_t kStatCounters = kMaxStatFunctions * kStatFields;
+
+// One thread's counters, written only by that thread. Defined here so that
+// a StatScope that takes no latency sample runs inline in its caller.
+struct StatThread {
+  struct Counters {
+    std::atomic<uint64_t> value[kStatCounters] = {};
+
+    void add(size_t counter) {
+      value[counter].store(value[counter].load(std::memory_order_relaxed) + 1,
+                           std::memory_order_relaxed);
+    }
+  } counters;
+  uint32_t countdown = kLatencySamplePeriod;
+  bool parse_failed = false;  // set by note_parse_failure()
+};
+
+// This thread's StatThread, cached after the first call so that each scope
+// reads one thread_local (in the extension's position-independent code
+// every thread_local read is a __tls_get_addr call)
+inline thread_local StatThread *t_stat_thread = nullptr;
+StatThread *register_stat_thread();
+
+inline StatThread *stat_thread() {
+  StatThread *thread = t_stat_thread;
+  return thread != nullptr ? thread : register_stat_thread();
+}
+
+// Id for name (registered once; the same name gets the same id), or -1
+// when all kMaxStatFunctions slots are taken. A -1 StatScope is a no-op.
+int register_stat_function(const char *name);
+
+// Marks the innermost StatScope on this thread as a parse failure
+inline void note_parse_failure() { stat_thread()->parse_failed = true; }
+
+class StatScope {
+ public:
+  StatScope(int function, bool null_argument)
+      : thread_(nullptr), base_(0), outer_failed_(false), start_ns_(0) {
+    if (function < 0) return;
+    StatThread *thread = stat_thread();
+    thread_ = thread;
+    base_ = static_cast<size_t>(function) * kStatFields;
+    outer_failed_ = thread->parse_failed;
+    thread->parse_failed = false;
+    thread->counters.add(base_ + kStatCalls);
+    if (null_argument) thread->counters.add(base_ + kStatNulls);
+    if (--thread->countdown == 0) start_sample();
+  }
+
+  ~StatScope() {
+    StatThread *thread = thread_;
+    if (thread == nullptr) return;
+    if (start_ns_ != 0) finish_sample();
+    if (thread->parse_failed) {
+      thread->counters.add(base_ + kStatParseFailures);
+    }
+    thread->parse_failed = outer_failed_;
+  }
+
+  StatScope(const StatScope &) = delete;
+  StatScope &operator=(const StatScope &) = delete;
+
+ private:
+  // One call in kLatencySamplePeriod per thread is timed, out of line
+  void start_sample();
+  void finish_sample();
+
+  StatThread *thread_;
+  size_t base_;
+  bool outer_failed_;
+  int64_t start_ns_;
+};
+#else
+inline void note_parse_failure() {}
+#endif
+
+// {"instrumented": true|false, "kernels": ..., "functions": {name: {...}}}
+bool stats_json(char *to, size_t to_size, size_t *to_length);
+void reset_stats();
+
+// Why an encoder rejected its input text
+enum class RejectReason : uint8_t {
+  kTooLong = 1,  // kMaxInputString bytes or more
+  kBadAddress,   // Not an address of the type
+  kBadPrefix,    // CIDR text without a numeric /masklen
+  kPrefixRange,  // masklen out of range for the family
+  kHostBits,     // CIDR with bits set right of the masklen
+  kWrongFamily,  // INET4/INET6 text of the other family
+};
+const char *reject_reason_name(RejectReason reason);
+
+// Recently rejected input texts, for diagnosing a failed load without
+// collecting every warning. Each thread records its first rejection and
+// then one in every sample period into a ring of kRejectRingSize entries
+// shared by all threads. Writers claim a slot without locking and drop the
+// sample if another writer holds it. Texts are kept up to kRejectTextBytes
+// bytes. A period of 0 stops recording, and is the default: the ring
+// holds other sessions' input. set_reject_sample_period returns the
+// previous period.
+static constexpr size_t kRejectRingSize = 64;
+static constexpr size_t kRejectTextBytes = 64;
+static constexpr uint32_t kDefaultRejectSamplePeriod = 0;
+static constexpr size_t kMaxRejectsJson = 65535;
+uint32_t set_reject_sample_period(uint32_t period);
+uint32_t reject_sample_period();
+
+// {"sample_period": ..., "recorded": ..., "rejects": [newest first]}
+bool recent_rejects_json(char *to, size_t to_size, size_t *to_length);
+
+// Comparison functions for each type (negative, zero or positive)
+int cmp_cidr(const unsigned char *data1, size_t len1, const unsigned char *data2, size_t len2);
+int cmp_inet(const unsigned char *data1, size_t len1, const unsigned char *data2, size_t len2);
+int cmp_macaddr(const unsigned char *data1, size_t len1, const unsigned char *data2, size_t len2);
+int cmp_macaddr8(const unsigned char *data1, size_t len1, const unsigned char *data2, size_t len2);
+
+// Mask calculations from a prefix length
+uint32_t prefix_to_netmask_ipv4(uint8_t prefix_len);
+uint32_t prefix_to_hostmask_ipv4(uint8_t prefix_len);
+void prefix_to_netmask_ipv6(uint8_t prefix_len, uint8_t *netmask);
+void prefix_to_hostmask_ipv6(uint8_t prefix_len, uint8_t *hostmask);
+
+// Simple extractors
+int inet_family(const unsigned char *buffer, size_t buffer_size);
+int inet_masklen(const unsigned char *buffer, size_t buffer_size);
+bool inet_host(const unsigned char *buffer, size_t buffer_size, char *result, size_t result_size, size_t *result_length);
+bool inet_text(const unsigned char *buffer, size_t buffer_size, char *result, size_t result_size, size_t *result_length);
+
+// Mask calculations
+bool inet_netmask(const unsigned char *buffer, size_t buffer_size,
+                  unsigned char *result_buffer, size_t *result_length);
+bool inet_hostmask(const unsigned char *buffer, size_t buffer_size,
+                   unsigned char *result_buffer, size_t *result_length);
+bool inet_broadcast(const unsigned char *buffer, size_t buffer_size,
+                    unsigned char *result_buffer, size_t *result_length);
+bool inet_network(const unsigned char *buffer, size_t buffer_size,
+                  unsigned char *result_buffer, size_t *result_length);
+
+// Modifiers
+bool inet_set_masklen(const unsigned char *buffer, size_t buffer_size,
+                      int new_masklen, unsigned char *result_buffer,
+                      size_t *result_length);
+bool cidr_set_masklen(const unsigned char *buffer, size_t buffer_size,
+                      int new_masklen, unsigned char *result_buffer,
+                      size_t *result_length);
+bool macaddr_trunc(const unsigned char *buffer, size_t buffer_size,
+                   unsigned char *result_buffer, size_t *result_length);
+
+// MACADDR as a packed big-endian integer (for BIGINT indexes and joins)
+bool macaddr_to_bigint(const unsigned char *buffer, size_t buffer_size,
+                       long long *value);
+bool macaddr_from_bigint(long long value, unsigned char *result_buffer,
+                         size_t *result_length);
+
+// Formatting (abbreviation)
+bool inet_abbrev(const unsigned char *buffer, size_t buffer_size, char *result, size_t result_size, size_t *result_length);
+bool cidr_abbrev(const unsigned char *buffer, size_t buffer_size, char *result, size_t result_size, size_t *result_length);
+
+// Prefix arithmetic
+int inet_common_prefix_len(const unsigned char *buffer1, size_t buffer1_size,
+                           const unsigned char *buffer2, size_t buffer2_size);
+bool inet_merge(const unsigned char *buffer1, size_t buffer1_size,
+                const unsigned char *buffer2, size_t buffer2_size,
+                unsigned char *result_buffer, size_t *result_length);
+bool inet_xor_distance(const unsigned char *buffer1, size_t buffer1_size,
+                       const unsigned char *buffer2, size_t buffer2_size,
+                       unsigned char *result_buffer, size_t *result_length);
+
+// Enumeration (JSON arrays of addresses)
+bool cidr_subnets(const unsigned char *buffer, size_t buffer_size,
+                  int new_masklen, long long limit, char *result,
+                  size_t result_size, size_t *result_length);
+bool cidr_hosts(const unsigned char *buffer, size_t buffer_size,
+                long long limit, char *result, size_t result_size,
+                size_t *result_length);
+bool inet_range_to_cidrs(const unsigned char *start_buffer, size_t start_size,
+                         const unsigned char *end_buffer, size_t end_size,
+                         char *result, size_t result_size,
+                         size_t *result_length);
+
+// Address lists
+bool inet_normalize_list(const char *list, size_t list_len,
+                         const char *sep, size_t sep_len, char *result,
+                         size_t result_size, size_t *result_length);
+int inet_validate_list(const char *list, size_t list_len,
+                       const char *sep, size_t sep_len);
+bool inet_sort_list(const char *list, size_t list_len,
+                    const char *sep, size_t sep_len, char *result,
+                    size_t result_size, size_t *result_length);
+
+// Containment
+
+// A network prepared for repeated containment tests: the family, masklen and
+// the network address and netmask as big-endian 64-bit words (IPv4 uses the
+// high word only), so each test is two masked compares.
+struct CompiledNetwork {
+  uint8_t family;
+  uint8_t masklen;
+  uint64_t network_hi;
+  uint64_t network_lo;
+  uint64_t mask_hi;
+  uint64_t mask_lo;
+};
+
+bool compile_network(const unsigned char *buffer, size_t buffer_size,
+                     CompiledNetwork *compiled);
+int network_includes(const CompiledNetwork &network,
+                     const unsigned char *buffer, size_t buffer_size,
+                     bool or_equals);
+
+// One-entry memo of the last network argument compiled on this thread. A
+// constant argument, such as the CIDR in
+// WHERE inet_contained_by(addr, inet_from_string('10.0.0.0/8')), arrives
+// with the same bytes on every row of a statement, so it is compiled once
+// and each later row costs a short memcmp instead.
+class CompiledNetworkCache {
+ public:
+  const CompiledNetwork *get(const unsigned char *buffer, size_t buffer_size) {
+    if (valid_ && buffer_size == length_ &&
+        memcmp(buffer, raw_, buffer_size) == 0) {
+      return &compiled_;
+    }
+    valid_ = false;
+    if (buffer == nullptr || buffer_size > sizeof(raw_) ||
+        compile_network(buffer, buffer_size, &compiled_)) {
+      return nullptr;
+    }
+    memcpy(raw_, buffer, buffer_size);
+    length_ = buffer_size;
+    valid_ = true;
+    return &compiled_;
+  }
+
+ private:
+  unsigned char raw_[sizeof(IPv6Network)];
+  size_t length_ = 0;
+  bool valid_ = false;
+  CompiledNetwork compiled_;
+};
+
+// Compact single-family types: big-endian address followed by masklen
+bool encode_inet4(unsigned char *buffer, size_t buffer_size, const char *from, size_t from_len, size_t *length);
+bool decode_inet4(const unsigned char *buffer, size_t buffer_size, char *to, size_t to_size, size_t *to_length);
+bool encode_inet6(unsigned char *buffer, size_t buffer_size, const char *from, size_t from_len, size_t *length);
+bool decode_inet6(const unsigned char *buffer, size_t buffer_size, char *to, size_t to_size, size_t *to_length);
+int cmp_inet4(const unsigned char *data1, size_t len1, const unsigned char *data2, size_t len2);
+int cmp_inet6(const unsigned char *data1, size_t len1, const unsigned char *data2, size_t len2);
+int inet4_masklen(const unsigned char *buffer, size_t buffer_size);
+int inet6_masklen(const unsigned char *buffer, size_t buffer_size);
+bool inet_to_inet4(const unsigned char *buffer, size_t buffer_size,
+                   unsigned char *result_buffer, size_t *result_length);
+bool inet4_to_inet(const unsigned char *buffer, size_t buffer_size,
+                   unsigned char *result_buffer, size_t *result_length);
+bool inet_to_inet6(const unsigned char *buffer, size_t buffer_size,
+                   unsigned char *result_buffer, size_t *result_length);
+bool inet6_to_inet(const unsigned char *buffer, size_t buffer_size,
+                   unsigned char *result_buffer, size_t *result_length);
+
+} // namespace network_address
+
+#endif // NETWORK_ADDRESS_CORE_H